@@ -105,6 +105,39 @@ function generateItemDisplayText(item) {
     }
 }
 
+// Memoised display text for indexed labels and values
+// Status boards redraw hundreds of items every refresh but few values change.
+// Every merge and every drawItem() makes new item objects so the memo is keyed by idx,
+// which stays the same between frames, and holds the fields used for the last text generated
+const DISPLAY_TEXT_FIELDS = ['type', 'text', 'textFormat', 'value', 'intValue', 'max', 'min', 'displayMax', 'displayMin', 'decimals', 'units'];
+
+// memoByIdx is a Map owned by the caller, e.g. one per Redraw, items without an idx are not memoised
+function getItemDisplayText(item, memoByIdx) {
+    if (!memoByIdx || item.idx === undefined) {
+        return generateItemDisplayText(item);
+    }
+    const memo = memoByIdx.get(item.idx);
+    if (memo) {
+        let same = true;
+        for (const field of DISPLAY_TEXT_FIELDS) {
+            if (memo.fields[field] !== item[field]) {
+                same = false;
+                break;
+            }
+        }
+        if (same) {
+            return memo.text;
+        }
+    }
+    const fields = {};
+    for (const field of DISPLAY_TEXT_FIELDS) {
+        fields[field] = item[field];
+    }
+    const text = generateItemDisplayText(item);
+    memoByIdx.set(item.idx, { fields: fields, text: text });
+    return text;
+}
+
 // Font size calculation for touchActionInput dialogs
 // fontSize 0 = 14px for dialog boxes, with baseFontSize = 14
 function getActualFontSizeForDialog(relativeFontSize) {
@@ -159,6 +192,7 @@ if (typeof window !== 'undefined') {
     window.printFloatDecimals = printFloatDecimals;
     window.addFormattedValueToText = addFormattedValueToText;
     window.generateItemDisplayText = generateItemDisplayText;
+    window.getItemDisplayText = getItemDisplayText;
     window.getActualFontSizeForDialog = getActualFontSizeForDialog;
     window.convertColorToHex = convertColorToHex;
 }
\ No newline at end of file
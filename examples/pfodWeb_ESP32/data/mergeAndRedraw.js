@@ -11,6 +11,124 @@
 // Note: Now a class to support multiple viewer instances
 // Uses separate Redraw module for actual drawing operations
 
+// Uniform grid over the merged touchZone bounds (dwg coords, before the 9mm touch enlargement)
+// filled as touchZones are merged so the mouse handlers only check the zones near the touch
+// zones covering more than maxCellsPerZone cells, e.g. a whole dwg touchZone, are always checked
+class TouchZoneIndex {
+    constructor(cellSize = 8, maxCellsPerZone = 64) {
+        this.cellSize = (cellSize > 0) ? cellSize : 8;
+        this.maxCellsPerZone = maxCellsPerZone;
+        this.cells = new Map(); // key "col,row" -> array of entries
+        this.largeEntries = [];
+        this.entriesByCmd = new Map();
+        this.nextSeq = 0;
+        this.queryStamp = 0;
+    }
+
+    // cellSize so the main dwg is about 32 x 32 cells
+    static forDrawingSize(width, height) {
+        return new TouchZoneIndex(Math.max(width, height, 1) / 32);
+    }
+
+    static fromTouchZones(allTouchZonesByCmd, cellSize) {
+        const index = new TouchZoneIndex(cellSize);
+        for (const cmd in allTouchZonesByCmd) {
+            index.set(cmd, allTouchZonesByCmd[cmd]);
+        }
+        return index;
+    }
+
+    get size() {
+        return this.entriesByCmd.size;
+    }
+
+    // add or replace the touchZone for cmd
+    set(cmd, zone) {
+        let entry = this.entriesByCmd.get(cmd);
+        if (entry) {
+            this.removeEntry(entry); // keeps its place in the cmd order
+        } else {
+            // for..in lists array index keys first, in numeric order, then the rest in insertion order
+            const isArrayIndex = /^(0|[1-9]\d*)$/.test(cmd) && Number(cmd) < 4294967295;
+            entry = { cmd: cmd, order: isArrayIndex ? Number(cmd) - 4294967296 : this.nextSeq++, stamp: 0, cellKeys: null };
+            this.entriesByCmd.set(cmd, entry);
+        }
+        const bounds = window.pfodWebMouse.calculateTouchZoneBounds(zone);
+        const colMin = Math.floor(bounds.left / this.cellSize);
+        const colMax = Math.floor(bounds.right / this.cellSize);
+        const rowMin = Math.floor(bounds.top / this.cellSize);
+        const rowMax = Math.floor(bounds.bottom / this.cellSize);
+        const numCells = (colMax - colMin + 1) * (rowMax - rowMin + 1);
+        if (!(numCells <= this.maxCellsPerZone)) { // also catches NaN bounds
+            this.largeEntries.push(entry);
+            return;
+        }
+        entry.cellKeys = [];
+        for (let col = colMin; col <= colMax; col++) {
+            for (let row = rowMin; row <= rowMax; row++) {
+                const key = `${col},${row}`;
+                let cell = this.cells.get(key);
+                if (!cell) {
+                    cell = [];
+                    this.cells.set(key, cell);
+                }
+                cell.push(entry);
+                entry.cellKeys.push(key);
+            }
+        }
+    }
+
+    removeEntry(entry) {
+        if (entry.cellKeys) {
+            for (const key of entry.cellKeys) {
+                const cell = this.cells.get(key);
+                cell.splice(cell.indexOf(entry), 1);
+                if (cell.length === 0) {
+                    this.cells.delete(key);
+                }
+            }
+            entry.cellKeys = null;
+        } else {
+            this.largeEntries.splice(this.largeEntries.indexOf(entry), 1);
+        }
+    }
+
+    // cmds of the touchZones that could contain (x,y) once enlarged by colExtra, rowExtra
+    // in the same order as for..in over allTouchZonesByCmd
+    query(x, y, colExtra = 0, rowExtra = 0) {
+        const colMin = Math.floor((x - colExtra) / this.cellSize);
+        const colMax = Math.floor((x + colExtra) / this.cellSize);
+        const rowMin = Math.floor((y - rowExtra) / this.cellSize);
+        const rowMax = Math.floor((y + rowExtra) / this.cellSize);
+        if ((colMax - colMin + 1) * (rowMax - rowMin + 1) > this.cells.size) {
+            // touch area covers more cells than are in use, just return them all
+            return [...this.entriesByCmd.values()].sort((a, b) => a.order - b.order).map(entry => entry.cmd);
+        }
+        const stamp = ++this.queryStamp;
+        const found = [];
+        for (const entry of this.largeEntries) {
+            entry.stamp = stamp;
+            found.push(entry);
+        }
+        for (let col = colMin; col <= colMax; col++) {
+            for (let row = rowMin; row <= rowMax; row++) {
+                const cell = this.cells.get(`${col},${row}`);
+                if (!cell) {
+                    continue;
+                }
+                for (const entry of cell) {
+                    if (entry.stamp !== stamp) {
+                        entry.stamp = stamp;
+                        found.push(entry);
+                    }
+                }
+            }
+        }
+        found.sort((a, b) => a.order - b.order);
+        return found.map(entry => entry.cmd);
+    }
+}
+
 // MergeAndRedraw class for isolated canvas rendering per viewer
 class MergeAndRedraw {
     constructor() {
@@ -42,6 +160,9 @@ class MergeAndRedraw {
         this.cachedCanvasWidth = 0;
         this.cachedCanvasHeight = 0;
         this.hasCompletedFirstDraw = false;
+
+        // hit test index for drawingManagerState.allTouchZonesByCmd, replaced on each merge
+        this.touchZoneIndex = new TouchZoneIndex();
     }
 
     // Helper methods to access drawing manager data
@@ -77,6 +198,12 @@ class MergeAndRedraw {
         return this.drawingManagerState.allTouchZonesByCmd || {};
     }
 
+    // Get the hit test index built when allTouchZonesByCmd was last merged
+    // touchActions replace allTouchZonesByCmd with copies so look up the cmds in the current copy
+    getTouchZoneIndex() {
+        return this.touchZoneIndex;
+    }
+
     // Get merged touchActions for mouse operations
     getAllTouchActionsByCmd() {
         return this.drawingManagerState.allTouchActionsByCmd || {};
@@ -135,7 +262,10 @@ class MergeAndRedraw {
         if (config.touchZonesByCmd) this.drawingManagerState.touchZonesByCmd = config.touchZonesByCmd;
         if (config.touchActionsByCmd) this.drawingManagerState.touchActionsByCmd = config.touchActionsByCmd;
         if (config.touchActionInputsByCmd) this.drawingManagerState.touchActionInputsByCmd = config.touchActionInputsByCmd;
-        if (config.allTouchZonesByCmd) this.drawingManagerState.allTouchZonesByCmd = config.allTouchZonesByCmd;
+        if (config.allTouchZonesByCmd) {
+            this.drawingManagerState.allTouchZonesByCmd = config.allTouchZonesByCmd;
+            this.touchZoneIndex = TouchZoneIndex.fromTouchZones(config.allTouchZonesByCmd, this.touchZoneIndex.cellSize);
+        }
         if (config.drawingResponseStatus) this.drawingManagerState.drawingResponseStatus = config.drawingResponseStatus;
         
         // Update the Redraw module state as well
@@ -204,6 +334,8 @@ class MergeAndRedraw {
         // Create the main clip region (full canvas logical size)
         const logicalCanvasWidth = currentDrawingData.data ? currentDrawingData.data.x || 50 : 50;
         const logicalCanvasHeight = currentDrawingData.data ? currentDrawingData.data.y || 50 : 50;
+        // new index, touchActionBackups keep the one that matches their copy of allTouchZonesByCmd
+        this.touchZoneIndex = TouchZoneIndex.forDrawingSize(logicalCanvasWidth, logicalCanvasHeight);
         const mainClipRegion = {
             x: 0,
             y: 0,
@@ -254,7 +386,9 @@ class MergeAndRedraw {
         for (let i = 0; i < this.drawingManagerState.allUnindexedItems.length; i++) {
             const item = this.drawingManagerState.allUnindexedItems[i];
             console.log(`[MERGE_REDRAW] DEBUG: Unindexed item ${i}: type=${item.type}, drawingName=${item.drawingName || 'none'}, transform=(${item.transform?.x},${item.transform?.y}), scale=${item.transform?.scale}`);
-            console.log(`[MERGE_REDRAW] DEBUG: Unindexed item ${i}: `,JSON.stringify(item,null,2));
+            if (isDebugLogging()) {
+                console.log(`[MERGE_REDRAW] DEBUG: Unindexed item ${i}: `,JSON.stringify(item,null,2));
+            }
         }
         
         // Only add items to draw if specifically needed for debugging
@@ -271,7 +405,9 @@ class MergeAndRedraw {
             sortedIndexes.forEach(index => {
                 const item = this.drawingManagerState.allIndexedItemsByNumber[index];
                 console.log(`  Index ${index}: Type: ${item.type || 'unknown'}, Drawing: ${item.drawingName || 'unknown'}`);
-               console.log(`[MERGE_REDRAW] DEBUG: Indexed item: `,JSON.stringify(item,null,2));
+               if (isDebugLogging()) {
+                   console.log(`[MERGE_REDRAW] DEBUG: Indexed item: `,JSON.stringify(item,null,2));
+               }
             });
         } else {
             console.log(`[MERGE_REDRAW] No indexed items found.`);
@@ -280,7 +416,9 @@ class MergeAndRedraw {
         if (Object.keys(this.drawingManagerState.allTouchZonesByCmd).length > 0) {
           for (const cmd in this.drawingManagerState.allTouchZonesByCmd) {
             const touchZone = this.drawingManagerState.allTouchZonesByCmd[cmd];
-            console.log(`[MERGE_REDRAW] DEBUG: touchZone item: `,JSON.stringify(touchZone,null,2));
+            if (isDebugLogging()) {
+                console.log(`[MERGE_REDRAW] DEBUG: touchZone item: `,JSON.stringify(touchZone,null,2));
+            }
           }
         } else {
            console.log(`[MERGE_REDRAW] No touchZone items found.`);
@@ -466,6 +604,7 @@ class MergeAndRedraw {
             }
             console.warn(`[MERGE_DWG] Added touchZone to allTouchZonesByCmd  ${JSON.stringify(processedItem)}`);
             allTouchZonesByCmd[touchZoneCmd] = processedItem;
+            this.touchZoneIndex.set(touchZoneCmd, processedItem);
            }
         }
         
@@ -634,4 +773,5 @@ class MergeAndRedraw {
 }
 
 // Export as global for browser compatibility
-window.MergeAndRedraw = MergeAndRedraw;
\ No newline at end of file
+window.MergeAndRedraw = MergeAndRedraw;
+window.TouchZoneIndex = TouchZoneIndex;
\ No newline at end of file
@@ -25,6 +25,9 @@ class DrawingViewer {
     // Extract target IP from URL or global variable
     this.targetIP = this.extractTargetIP();
     console.log('[PFODWEB_DEBUG] Target IP:', this.targetIP);
+    // proxy mode, route device requests via the pfodWebServer that served this page
+    this.useProxy = this.extractUseProxy();
+    console.log('[PFODWEB_DEBUG] Use proxy:', this.useProxy);
 
     // DOM Elements
     this.canvas = document.getElementById('drawing-canvas');
@@ -138,9 +141,24 @@ class DrawingViewer {
     return null;
   }
 
+  // Extract proxy setting from URL parameters (e.g., ?targetIP=192.168.1.100&proxy=true)
+  // only used when a targetIP is set
+  extractUseProxy() {
+    const urlParams = new URLSearchParams(window.location.search);
+    const proxy = urlParams.get('proxy');
+    return (!!this.targetIP && (proxy === 'true' || proxy === '1'));
+  }
+
   // Build endpoint URL with target IP
+  // in proxy mode requests go to /device/<targetIP>/pfodWeb on the pfodWebServer
   buildEndpoint(path) {
     if (this.targetIP) {
+      if (path.startsWith('?')) {
+        path = `/pfodWeb${path}`; // relative ?cmd= requests are for /pfodWeb
+      }
+      if (this.useProxy) {
+        return `/device/${this.targetIP}${path}`;
+      }
       return `http://${this.targetIP}${path}`;
     }
     return path; // Fallback to relative URL
@@ -154,8 +172,8 @@ class DrawingViewer {
         'X-Requested-With': 'XMLHttpRequest',
         ...additionalHeaders
       },
-      mode: this.targetIP ? 'cors' : 'same-origin',
-      credentials: this.targetIP ? 'omit' : 'same-origin',
+      mode: (this.targetIP && !this.useProxy) ? 'cors' : 'same-origin',
+      credentials: (this.targetIP && !this.useProxy) ? 'omit' : 'same-origin',
       cache: 'no-cache'
     };
   }
@@ -631,10 +649,10 @@ class DrawingViewer {
       }
       // Ensure endpoint has full URL with target IP if it's a relative path
       let endpoint = request.endpoint;
-      console.log(`[QUEUE] Original endpoint: ${endpoint}, targetIP: ${this.targetIP}`);
-      if (endpoint.startsWith('/') && this.targetIP) {
-        endpoint = `http://${this.targetIP}${endpoint}`;
-        console.log(`[QUEUE] Transformed endpoint to HTTP: ${endpoint}`);
+      console.log(`[QUEUE] Original endpoint: ${endpoint}, targetIP: ${this.targetIP}, proxy: ${this.useProxy}`);
+      if ((endpoint.startsWith('/') || endpoint.startsWith('?')) && this.targetIP) {
+        endpoint = this.buildEndpoint(endpoint);
+        console.log(`[QUEUE] Transformed endpoint to: ${endpoint}`);
       }
       
       const response = await fetch(endpoint, request.options);
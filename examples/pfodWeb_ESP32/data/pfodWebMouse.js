@@ -118,6 +118,7 @@ window.pfodWebMouse = {
         transform: transformBackup,
         clipArea: clipAreaBackup,
         allTouchZonesByCmd: allTouchZonesBackup,
+        touchZoneIndex: this.mergeAndRedraw.getTouchZoneIndex(), // matches allTouchZonesBackup, later merges make a new one
         allUnindexedItems: allUnindexedItemsBackup,
         allIndexedItemsByNumber: allIndexedItemsByNumberBackup,
         touchActions: touchActionsBackup,
@@ -470,13 +471,19 @@ window.pfodWebMouse = {
     }
     
     const allTouchZones = window.pfodWebMouse.touchActionBackups?.allTouchZonesByCmd;
-    console.log(`[FIND_TOUCH_ZONE] DEBUG allTouchZonesByCmd returned ${Object.keys(allTouchZones || {}).length} touchZones:`, Object.keys(allTouchZones || {}));
     if (allTouchZones === undefined) {
         console.error(`[FIND_TOUCH_ZONE] allTouchZonesByCmd returned undefined during ${this.touchState?.isDown ? 'DRAG' : 'NORMAL'} operation`);
         return null;
     }
-    for (const cmd in allTouchZones) {
+    // only check the touchZones in the grid cells near x,y, in the same order as allTouchZonesByCmd
+    const touchZoneIndex = window.pfodWebMouse.touchActionBackups.touchZoneIndex;
+    const nearbyCmds = touchZoneIndex ? touchZoneIndex.query(x, y, colExtra, rowExtra) : Object.keys(allTouchZones);
+    console.log(`[FIND_TOUCH_ZONE] DEBUG checking ${nearbyCmds.length} touchZones near (${x},${y})`);
+    for (const cmd of nearbyCmds) {
       const zone = allTouchZones[cmd];
+      if (!zone) {
+        continue;
+      }
 
       // Only include visible and non-disabled zones
       if (zone.visible !== false && zone.filter !== TouchZoneFilters.TOUCH_DISABLED) {
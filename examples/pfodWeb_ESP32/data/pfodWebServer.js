@@ -1,14 +1,240 @@
+/*
+   pfodWebServer.js
+ * (c)2025 Forward Computing and Control Pty. Ltd.
+ * NSW Australia, www.forward.com.au
+ * This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+ * This generated code may be freely used for both private and commercial use
+ * provided this copyright is maintained.
+ */
+
+// Serves the pfodWeb data files.
+// Optional proxy mode, start with
+//    node pfodWebServer.js --proxy [--ttl=500]
+// or set env PFOD_PROXY=1 (and PFOD_PROXY_TTL=500)
+// In proxy mode browsers send device commands to
+//    /device/<ip>/pfodWeb?cmd=...   (or <ip>:<port> for a device not on port 80)
+// and this server forwards them to http://<ip>/pfodWeb?cmd=...
+//  - identical read-only requests (drawing/menu refreshes) in flight are sent to the device once
+//    and the reply is returned to all the browsers waiting on it
+//  - read-only replies are cached for ttl ms so many browsers watching the same drawing only load the device once
+//  - touch commands (containing ~ or `) are always forwarded and clear that device's cache
+//  - only one request at a time is sent to each device
+// Set env PFOD_PROXY_DEVICES=192.168.1.100,192.168.1.101 to limit which devices can be proxied
+// GET /proxyStats returns the proxy counters as json
+
 const express = require('express');
+const http = require('http');
 const path = require('path');
 
 const app = express();
 const PORT = process.env.PORT || 8080;
 
+function getArg(name) {
+  for (const arg of process.argv.slice(2)) {
+    if (arg === `--${name}`) {
+      return 'true';
+    }
+    if (arg.startsWith(`--${name}=`)) {
+      return arg.substring(name.length + 3);
+    }
+  }
+  return undefined;
+}
+
+// a bare --ttl or a value that is not a number would give NaN and turn off both cache hits and expiry
+function parseTTL(ttlArg) {
+  if (ttlArg === undefined) {
+    return DEFAULT_PROXY_TTL;
+  }
+  const ttl = Number(ttlArg);
+  if (!Number.isFinite(ttl) || (ttl < 0)) {
+    console.warn(`Invalid proxy ttl '${ttlArg}', using ${DEFAULT_PROXY_TTL}ms`);
+    return DEFAULT_PROXY_TTL;
+  }
+  return ttl;
+}
+
+const proxyArg = getArg('proxy') || process.env.PFOD_PROXY;
+const PROXY_ENABLED = (proxyArg === 'true') || (proxyArg === '1');
+const DEFAULT_PROXY_TTL = 500;
+const PROXY_TTL = parseTTL(getArg('ttl') || process.env.PFOD_PROXY_TTL); // ms to cache read-only replies
+const DEVICE_TIMEOUT = 10000; // ms
+const allowedDevices = (process.env.PFOD_PROXY_DEVICES || '').split(',').map(d => d.trim()).filter(d => d.length > 0);
+
 // Serve static files from current directory
 app.use(express.static(__dirname));
 
+if (PROXY_ENABLED) {
+  const deviceAgents = new Map(); // device -> http.Agent, one socket per device
+  const inFlight = new Map(); // key -> Promise of reply
+  const cache = new Map(); // key -> { time, reply }
+  const deviceGenerations = new Map(); // device -> count of touch commands, so stale in flight replies are not cached
+  const stats = {
+    requests: 0,
+    deviceRequests: 0,
+    cacheHits: 0,
+    coalesced: 0,
+    errors: 0
+  };
+
+  // ip or ip:port
+  function isValidDevice(device) {
+    const match = /^(\d{1,3}(?:\.\d{1,3}){3})(?::(\d{1,5}))?$/.exec(device);
+    if (!match) {
+      return false;
+    }
+    if (!match[1].split('.').every(part => parseInt(part, 10) <= 255)) {
+      return false;
+    }
+    if (match[2] && (parseInt(match[2], 10) > 65535)) {
+      return false;
+    }
+    return ((allowedDevices.length === 0) || allowedDevices.includes(device));
+  }
+
+  // drawing and menu requests {.} {dwgName} {version:dwgName} do not change the device state
+  // touch commands {pfodWeb~cmd`col`row`type} do
+  function isReadOnlyCmd(cmd) {
+    return /^\{[^~`!|]*\}$/.test(cmd.trim());
+  }
+
+  function getAgent(device) {
+    let agent = deviceAgents.get(device);
+    if (!agent) {
+      agent = new http.Agent({ keepAlive: false, maxSockets: 1 }); // device handles one request at a time
+      deviceAgents.set(device, agent);
+    }
+    return agent;
+  }
+
+  function clearDeviceCache(device) {
+    deviceGenerations.set(device, (deviceGenerations.get(device) || 0) + 1);
+    const prefix = `${device}/`;
+    for (const key of cache.keys()) {
+      if (key.startsWith(prefix)) {
+        cache.delete(key);
+      }
+    }
+  }
+
+  function removeExpired(now) {
+    for (const [key, entry] of cache) {
+      if ((now - entry.time) > PROXY_TTL) {
+        cache.delete(key);
+      }
+    }
+  }
+
+  // returns Promise of { status, contentType, body }
+  function sendToDevice(device, pathAndQuery) {
+    const [host, port] = device.split(':');
+    stats.deviceRequests++;
+    return new Promise((resolve, reject) => {
+      const req = http.get({
+        host: host,
+        port: port ? parseInt(port, 10) : 80,
+        path: pathAndQuery,
+        agent: getAgent(device),
+        headers: { 'Accept': 'application/json' }
+      }, (res) => {
+        const chunks = [];
+        res.on('data', chunk => chunks.push(chunk));
+        res.on('end', () => resolve({
+          status: res.statusCode,
+          contentType: res.headers['content-type'] || 'application/json',
+          body: Buffer.concat(chunks)
+        }));
+        res.on('error', reject);
+      });
+      req.setTimeout(DEVICE_TIMEOUT, () => req.destroy(new Error(`device ${device} timed out`)));
+      req.on('error', reject);
+    });
+  }
+
+  function sendReply(res, reply, source) {
+    res.set('Cache-Control', 'no-store');
+    res.set('X-pfodProxy', source);
+    res.status(reply.status).type(reply.contentType).send(reply.body);
+  }
+
+  async function handleDeviceRequest(req, res, page) {
+    stats.requests++;
+    const device = req.params.device;
+    if (!isValidDevice(device)) {
+      res.status(403).type('text/plain').send(`Device ${device} not allowed`);
+      return;
+    }
+    const cmd = (typeof req.query.cmd === 'string') ? req.query.cmd : '';
+    const queryIdx = req.originalUrl.indexOf('?');
+    const query = (queryIdx >= 0) ? req.originalUrl.substring(queryIdx) : '';
+    const pathAndQuery = `/${page}${query}`;
+
+    if (!cmd || !isReadOnlyCmd(cmd)) {
+      // page requests and touch commands always go to the device
+      try {
+        const reply = await sendToDevice(device, pathAndQuery);
+        if (cmd) {
+          clearDeviceCache(device); // device state may have changed
+        }
+        sendReply(res, reply, 'forward');
+      } catch (error) {
+        stats.errors++;
+        console.log(`Proxy error for ${device}${pathAndQuery}: ${error.message}`);
+        res.status(502).type('text/plain').send(error.message);
+      }
+      return;
+    }
+
+    const key = `${device}${pathAndQuery}`;
+    const now = Date.now();
+    const cached = cache.get(key);
+    if (cached && ((now - cached.time) <= PROXY_TTL)) {
+      stats.cacheHits++;
+      sendReply(res, cached.reply, 'hit');
+      return;
+    }
+
+    let source = 'coalesced';
+    let pending = inFlight.get(key);
+    if (pending) {
+      stats.coalesced++;
+    } else {
+      source = 'miss';
+      const generation = deviceGenerations.get(device) || 0;
+      pending = sendToDevice(device, pathAndQuery);
+      inFlight.set(key, pending);
+      pending.then((reply) => {
+        if ((reply.status === 200) && (generation === (deviceGenerations.get(device) || 0))) {
+          const time = Date.now();
+          removeExpired(time);
+          cache.set(key, { time: time, reply: reply });
+        }
+      }, () => {}).finally(() => inFlight.delete(key));
+    }
+    try {
+      sendReply(res, await pending, source);
+    } catch (error) {
+      stats.errors++;
+      console.log(`Proxy error for ${key}: ${error.message}`);
+      res.status(502).type('text/plain').send(error.message);
+    }
+  }
+
+  app.get('/device/:device/pfodWeb', (req, res) => handleDeviceRequest(req, res, 'pfodWeb'));
+  app.get('/device/:device/pfodWebDebug', (req, res) => handleDeviceRequest(req, res, 'pfodWebDebug'));
+  app.get('/proxyStats', (req, res) => {
+    res.json({ ...stats, ttl: PROXY_TTL, cached: cache.size, inFlight: inFlight.size });
+  });
+}
+
 // Start server
 app.listen(PORT, () => {
     console.log(`pfodWebServer running on http://localhost:${PORT}`);
     console.log(`Open http://localhost:${PORT} in your browser`);
-});
\ No newline at end of file
+    if (PROXY_ENABLED) {
+      console.log(`Proxy mode on, device requests via http://localhost:${PORT}/device/<ip>/pfodWeb  cache ttl ${PROXY_TTL}ms`);
+      if (allowedDevices.length) {
+        console.log(`Proxy limited to devices: ${allowedDevices.join(', ')}`);
+      }
+    }
+});
@@ -54,6 +54,7 @@ echo "3. Click 'Launch pfodWebDebug' for debug interface with console logging"
 echo
 echo "The pfodWeb interface will send menu requests to your specified IP"
 echo "while serving all web files from this server."
+echo "Add --proxy to route device requests via this server and combine identical requests from many browsers"
 echo
 
-node pfodWebServer.js
\ No newline at end of file
+node pfodWebServer.js "$@"
\ No newline at end of file
@@ -10,10 +10,18 @@
 // Redraw module - handles all canvas drawing operations
 // Supports multiple independent viewer instances
 
+// true if pfodWeb.js left console logging on, see DEBUG in pfodWeb.js
+// log arguments are built even when console.log does nothing, so guard the costly ones, e.g. JSON.stringify(item)
+function isDebugLogging() {
+    return (typeof DEBUG !== 'undefined') && (DEBUG !== false) && (DEBUG !== 'false');
+}
+
 // Convert relative fontSize to actual pixel size
 // fontSize 0 = 2.9, +1 = 2.9*1.1225, -1 = 2.9/1.1225, etc.
 // +6 doubles size, -6 halves size
 // relativeFontSize must be an integer
+// results are cached as only a few font sizes are used
+const actualFontSizes = new Map();
 function getActualFontSize(relativeFontSize) {
     const baseFontSize = 2.9;
     const factor = 1.1225;
@@ -21,13 +29,19 @@ function getActualFontSize(relativeFontSize) {
     // Ensure we have an integer
     const intFontSize = Math.round(relativeFontSize);
     
+    let actualFontSize = actualFontSizes.get(intFontSize);
+    if (actualFontSize !== undefined) {
+        return actualFontSize;
+    }
     if (intFontSize === 0) {
-        return baseFontSize;
+        actualFontSize = baseFontSize;
     } else if (intFontSize > 0) {
-        return baseFontSize * Math.pow(factor, intFontSize);
+        actualFontSize = baseFontSize * Math.pow(factor, intFontSize);
     } else {
-        return baseFontSize / Math.pow(factor, Math.abs(intFontSize));
+        actualFontSize = baseFontSize / Math.pow(factor, Math.abs(intFontSize));
     }
+    actualFontSizes.set(intFontSize, actualFontSize);
+    return actualFontSize;
 }
 
 // Import formatting utilities
@@ -146,6 +160,44 @@ function convertColorToHex(color, backgroundColorNumber = null) {
     return '#000000';
 }
 
+// Text layout cache, keyed by (text, font, alignment) where font includes the size
+// holds the text split into lines and, once measured, the line widths
+// Map keeps insertion order so the least recently used entry is the first one
+class TextLayoutCache {
+    constructor(maxEntries = 2000) {
+        this.maxEntries = maxEntries;
+        this.layouts = new Map();
+    }
+
+    get(text, font, align) {
+        const key = `${font}\u0000${align}\u0000${text}`;
+        let layout = this.layouts.get(key);
+        if (layout) {
+            // move to most recently used
+            this.layouts.delete(key);
+        } else {
+            layout = { lines: text.split('\n'), widths: null };
+            if (this.layouts.size >= this.maxEntries) {
+                this.layouts.delete(this.layouts.keys().next().value);
+            }
+        }
+        this.layouts.set(key, layout);
+        return layout;
+    }
+
+    // ctx.font must already be set to the font used in get()
+    getWidths(ctx, layout) {
+        if (!layout.widths) {
+            layout.widths = layout.lines.map(line => ctx.measureText(line).width);
+        }
+        return layout.widths;
+    }
+
+    clear() {
+        this.layouts.clear();
+    }
+}
+
 class Redraw {
     constructor() {
         // Instance variables for multi-viewer isolation
@@ -160,6 +212,11 @@ class Redraw {
         this.cachedCanvasWidth = 0;
         this.cachedCanvasHeight = 0;
         this.hasCompletedFirstDraw = false;
+
+        // label and value text layouts, only re-split and re-measured when text or font changes
+        this.textLayoutCache = new TextLayoutCache();
+        // display text of indexed labels and values by idx, only regenerated when their value fields change
+        this.displayTextByIdx = new Map();
     }
 
     // Initialize with canvas and drawing manager state
@@ -280,7 +337,9 @@ class Redraw {
             const itemWithIndex = allIndexedItemsByNumber[idx];
             const drawingSource = itemWithIndex.parentDrawingName || 'unknown';
             console.log(`[REDRAW] Drawing indexed item ${idx} of type ${itemWithIndex.type} from ${drawingSource}`);
-            console.log(`[REDRAW_INDEXED_DEBUG] Item ${idx} full data:`, JSON.stringify(itemWithIndex, null, 2));
+            if (isDebugLogging()) {
+                console.log(`[REDRAW_INDEXED_DEBUG] Item ${idx} full data:`, JSON.stringify(itemWithIndex, null, 2));
+            }
             if (itemWithIndex.transform) {
                 console.log(`[REDRAW] Indexed item transform: x=${itemWithIndex.transform.x}, y=${itemWithIndex.transform.y}, scale=${itemWithIndex.transform.scale}`);
             } else {
@@ -321,7 +380,9 @@ class Redraw {
         item.clipRegion = itemClipRegion;
 
         try {
-            console.log(`[DRAWING] Drawing item of type: ${item.type}`, JSON.stringify(item));
+            if (isDebugLogging()) {
+                console.log(`[DRAWING] Drawing item of type: ${item.type}`, JSON.stringify(item));
+            }
             
             // Check if item is visible
             if (item.visible === false) {
@@ -539,7 +600,9 @@ class Redraw {
 
     // Draw a label
     drawLabel(item) {
-        console.log('[DRAWING_LABEL] Drawing label - Raw item:', JSON.stringify(item));
+        if (isDebugLogging()) {
+            console.log('[DRAWING_LABEL] Drawing label - Raw item:', JSON.stringify(item));
+        }
 
         // Check if label should be visible
         if (item.visible === false) {
@@ -551,7 +614,7 @@ class Redraw {
         const xOffset = parseFloat(item.xOffset || 0);
         const yOffset = parseFloat(item.yOffset || 0);
         // Generate label text: if label has a value, combine text+FloatDecimals(value,decimals)+units
-        const text = addFormattedValueToText(item.text || '', item);
+        const text = getItemDisplayText(item, this.displayTextByIdx);
         const relativeFontSize = parseInt(item.fontSize || 0);
         const fontSize = getActualFontSize(relativeFontSize);
         const bold = item.bold === 'true' || item.bold === true;
@@ -597,46 +660,16 @@ class Redraw {
             textX = canvasX; // xOffset position is where left edge will be
         }
 
-        // Split text by newlines and draw each line separately
-        const lines = text.split('\n');
-        const lineHeight = canvasFontSize * 1.0; // 1.0x font size for line spacing
-        
-        // Calculate starting Y position for multi-line text (center the block vertically)
-        const totalHeight = (lines.length - 1) * lineHeight;
-        let startY = canvasY - (totalHeight / 2);
-        
-        lines.forEach((line, index) => {
-            const lineY = startY + (index * lineHeight);
-            
-            // Draw the line at the calculated position
-            this.ctx.fillText(line, textX, lineY);
-
-            // Draw underline for this line if specified
-            if (underline) {
-                const textMetrics = this.ctx.measureText(line);
-                const underlineY = lineY + canvasFontSize / 2;
-                let underlineX = textX;
-                let underlineWidth = textMetrics.width;
-
-                if (align === 'center') {
-                    underlineX = textX - textMetrics.width / 2;
-                } else if (align === 'right') {
-                    underlineX = textX - textMetrics.width;
-                }
-
-                this.ctx.beginPath();
-                this.ctx.moveTo(underlineX, underlineY);
-                this.ctx.lineTo(underlineX + underlineWidth, underlineY);
-                this.ctx.stroke();
-            }
-        });
+        this.drawTextLines(text, fontStyle, align, textX, canvasY, canvasFontSize, underline);
 
         console.log(`[DRAWING_LABEL] Label drawn: "${text}" at (${canvasX}, ${canvasY})`);
     }
 
     // Draw a value
     drawValue(item) {
-        console.log('[DRAWING_VALUE] Drawing value - Raw item:', JSON.stringify(item));
+        if (isDebugLogging()) {
+            console.log('[DRAWING_VALUE] Drawing value - Raw item:', JSON.stringify(item));
+        }
 
         // Check if value should be visible
         if (item.visible === false) {
@@ -647,35 +680,17 @@ class Redraw {
         const transform = item.transform || { x: 0, y: 0, scale: 1.0 };
         const xOffset = parseFloat(item.xOffset || 0);
         const yOffset = parseFloat(item.yOffset || 0);
-        const textPrefix = item.text || '';
         const relativeFontSize = parseInt(item.fontSize || 0);
         const fontSize = getActualFontSize(relativeFontSize);
         const bold = item.bold === 'true' || item.bold === true;
         const italic = item.italic === 'true' || item.italic === true;
         const underline = item.underline === 'true' || item.underline === true;
         const align = item.align || 'left';
-        const intValue = parseFloat(item.intValue || 0);
-        const max = parseFloat(item.max || 1);
-        const min = parseFloat(item.min || 0);
-        const displayMax = parseFloat(item.displayMax || 1.0);
-        const displayMin = parseFloat(item.displayMin || 0.0);
-        const decimals = (item.decimals !== undefined && item.decimals !== null) ? parseInt(item.decimals) : 2;
-        const units = item.units || '';
-
-        // Calculate scaled value using the mapping function
-        let maxMin = max - min;
-        if (maxMin === 0) {
-            maxMin = 1;
-        }
-        const scaledValue = (intValue - min) * (displayMax - displayMin) / maxMin + displayMin;
 
-        // Format the scaled value to specified decimals (supports negative decimals)
-        const formattedValue = printFloatDecimals(scaledValue, decimals);
+        // Create the final display text, text + scaled/formatted intValue + units
+        const displayText = getItemDisplayText(item, this.displayTextByIdx);
 
-        // Create the final display text
-        const displayText = textPrefix + formattedValue + units;
-
-        console.log(`[DRAWING_VALUE] Calculated scaled value: ${intValue} -> ${scaledValue} (${formattedValue}) -> "${displayText}"`);
+        console.log(`[DRAWING_VALUE] Display text for intValue ${item.intValue} -> "${displayText}"`);
 
         // Calculate actual position with transform
         const actualX = (xOffset * transform.scale) + transform.x;
@@ -715,13 +730,23 @@ class Redraw {
             textX = canvasX; // xOffset position is where left edge will be
         }
 
-        // Split text by newlines and draw each line separately
-        const lines = displayText.split('\n');
+        this.drawTextLines(displayText, fontStyle, align, textX, canvasY, canvasFontSize, underline);
+
+        console.log(`[DRAWING_VALUE] Value drawn: "${displayText}" at (${canvasX}, ${canvasY})`);
+    }
+
+    // Draw text split into lines, centered vertically on canvasY
+    // ctx.font, textAlign and textBaseline must already be set
+    drawTextLines(text, fontStyle, align, textX, canvasY, canvasFontSize, underline) {
+        const layout = this.textLayoutCache.get(text, fontStyle, align);
+        const lines = layout.lines;
         const lineHeight = canvasFontSize * 1.0; // 1.0x font size for line spacing
         
         // Calculate starting Y position for multi-line text (center the block vertically)
         const totalHeight = (lines.length - 1) * lineHeight;
         let startY = canvasY - (totalHeight / 2);
+        // only measured for underlines, and then only once per text and font
+        const widths = underline ? this.textLayoutCache.getWidths(this.ctx, layout) : null;
         
         lines.forEach((line, index) => {
             const lineY = startY + (index * lineHeight);
@@ -731,15 +756,14 @@ class Redraw {
 
             // Draw underline for this line if specified
             if (underline) {
-                const textMetrics = this.ctx.measureText(line);
                 const underlineY = lineY + canvasFontSize / 2;
                 let underlineX = textX;
-                let underlineWidth = textMetrics.width;
+                let underlineWidth = widths[index];
 
                 if (align === 'center') {
-                    underlineX = textX - textMetrics.width / 2;
+                    underlineX = textX - underlineWidth / 2;
                 } else if (align === 'right') {
-                    underlineX = textX - textMetrics.width;
+                    underlineX = textX - underlineWidth;
                 }
 
                 this.ctx.beginPath();
@@ -748,13 +772,13 @@ class Redraw {
                 this.ctx.stroke();
             }
         });
-
-        console.log(`[DRAWING_VALUE] Value drawn: "${displayText}" at (${canvasX}, ${canvasY})`);
     }
 
     // Draw a line
     drawLine(item) {
-        console.log('[DRAWING_LINE] Drawing line - Raw item:', JSON.stringify(item));
+        if (isDebugLogging()) {
+            console.log('[DRAWING_LINE] Drawing line - Raw item:', JSON.stringify(item));
+        }
 
         // Check if touchZone should be visible
         if (item.visible === false) {
@@ -845,7 +869,9 @@ class Redraw {
      
     // Draw a rectangle
     drawRectangle(item) {
-        console.log('[DRAWING_RECTANGLE] Drawing rectangle - Raw item:', JSON.stringify(item));
+        if (isDebugLogging()) {
+            console.log('[DRAWING_RECTANGLE] Drawing rectangle - Raw item:', JSON.stringify(item));
+        }
         
         try {
             
@@ -1187,7 +1213,9 @@ class Redraw {
 
     // Draw a circle
     drawCircle(item) {
-        console.log('[DRAWING_CIRCLE] Drawing circle - Raw item:', JSON.stringify(item));
+        if (isDebugLogging()) {
+            console.log('[DRAWING_CIRCLE] Drawing circle - Raw item:', JSON.stringify(item));
+        }
 
         // Check if circle should be visible
         if (item.visible === false) {
@@ -1238,7 +1266,9 @@ class Redraw {
 
     // Draw an arc
     drawArc(item) {
-        console.log('[DRAWING_ARC] Drawing arc - Raw item:', JSON.stringify(item));
+        if (isDebugLogging()) {
+            console.log('[DRAWING_ARC] Drawing arc - Raw item:', JSON.stringify(item));
+        }
 
         // Check if arc should be visible
         if (item.visible === false) {
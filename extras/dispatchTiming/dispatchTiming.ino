@@ -0,0 +1,147 @@
+/*
+   dispatchTiming  times the pfodWeb and pfodApp server dispatch on the ESP32
+   Only uses the default server calls, so it builds against both older and newer versions of this library
+   to compare the dispatch time of the same cmds.
+   Every pfod cmd is answered with {} so the time measured is the server's receive, parse, dispatch and send,
+   not the sketch's menu and drawing code.
+
+   Each ESP32_handle_pfodWebServer() / ESP32_handle_pfodAppServer() call is timed with micros() and counted as
+   a cmd call if handle_pfodMainMenu() parsed a cmd during it, otherwise as an idle call.
+   Every 10sec prints the count, avg and max us of each, and the free heap at startup.
+
+   Load it with pfod cmds only, static file requests are counted as idle calls, e.g.
+     while true; do curl -s "http://<ip>/pfodWeb?cmd=%7B.%7D" > /dev/null; done
+     yes '{.}' | nc <ip> 4989 > /dev/null
+   To build against an older version of this library, check it out with git worktree and use
+     arduino-cli compile --fqbn esp32:esp32:esp32 --library <worktree> --upload -p <port> extras/dispatchTiming
+
+ * (c)2025 Forward Computing and Control Pty. Ltd.
+ * NSW Australia, www.forward.com.au
+ * This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+ * This generated code may be freely used for both private and commercial use
+ * provided this copyright is maintained.
+ */
+
+#include <WiFi.h>
+#include "ESP32_pfodWebServer.h"
+#include "ESP32_pfodAppServer.h"
+
+const char version[] = "V1";
+
+// =================== WiFi settings ===================
+const char *ssid = "xxxxx";
+const char *password = "xxxxx";
+
+const unsigned long PRINT_INTERVAL_ms = 10000;
+
+struct DispatchTimes {
+  uint32_t cmdCalls;
+  uint64_t cmdTotal_us;
+  uint32_t cmdMax_us;
+  uint32_t idleCalls;
+  uint64_t idleTotal_us;
+  uint32_t idleMax_us;
+};
+
+static DispatchTimes webTimes;
+static DispatchTimes appTimes;
+static bool cmdParsed = false; // set by handle_pfodMainMenu
+static uint32_t startupFreeHeap = 0;
+static unsigned long lastPrint_ms = 0;
+
+void handle_pfodMainMenu(pfodParser & parser) {
+  uint8_t cmd = parser.parse();
+  if (cmd != 0) {
+    cmdParsed = true;
+    parser.print("{}"); // always send back a pfod msg otherwise pfodApp will disconnect.
+  }
+}
+
+static void addTime(DispatchTimes & times, uint32_t time_us) {
+  if (cmdParsed) {
+    times.cmdCalls++;
+    times.cmdTotal_us += time_us;
+    if (time_us > times.cmdMax_us) {
+      times.cmdMax_us = time_us;
+    }
+  } else {
+    times.idleCalls++;
+    times.idleTotal_us += time_us;
+    if (time_us > times.idleMax_us) {
+      times.idleMax_us = time_us;
+    }
+  }
+}
+
+static void printTimes(const char *name, DispatchTimes & times) {
+  Serial.print(name);
+  Serial.print(" cmds:"); Serial.print(times.cmdCalls);
+  if (times.cmdCalls) {
+    Serial.print(" avg us:"); Serial.print((uint32_t)(times.cmdTotal_us / times.cmdCalls));
+    Serial.print(" max us:"); Serial.print(times.cmdMax_us);
+  }
+  Serial.print("  idle calls:"); Serial.print(times.idleCalls);
+  if (times.idleCalls) {
+    Serial.print(" avg us:"); Serial.print((float)times.idleTotal_us / times.idleCalls, 2);
+    Serial.print(" max us:"); Serial.print(times.idleMax_us);
+  }
+  Serial.println();
+  memset(&times, 0, sizeof(times));
+}
+
+static void setupWiFi() {
+  Serial.print(F("WiFi setup -- "));
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(ssid, password);
+  Serial.print("Connecting to ");
+  Serial.println(ssid);
+  uint8_t i = 0;
+  while (WiFi.status() != WL_CONNECTED && i++ < 20) {  //wait 10 seconds
+    delay(500);
+  }
+  if (i == 21) {
+    Serial.print("Could not connect to ");
+    Serial.println(ssid);
+    while (1) {
+      delay(500);
+    }
+  }
+  Serial.print("Connected! IP address: ");
+  Serial.println(WiFi.localIP());
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  for (int i = 10; i > 0; i--) {
+    Serial.print(i); Serial.print(' ');
+    delay(500);
+  }
+  Serial.println();
+
+  setupWiFi();
+
+  ESP32_start_pfodWebServer(version, "http://localhost:8080"); // pages served elsewhere, so LittleFS is not needed
+  ESP32_start_pfodAppServer(version);
+  startupFreeHeap = ESP.getFreeHeap();
+  Serial.print("Free heap after start:"); Serial.println(startupFreeHeap);
+  lastPrint_ms = millis();
+}
+
+void loop(void) {
+  cmdParsed = false;
+  uint32_t start_us = micros();
+  ESP32_handle_pfodWebServer();
+  addTime(webTimes, micros() - start_us);
+
+  cmdParsed = false;
+  start_us = micros();
+  ESP32_handle_pfodAppServer();
+  addTime(appTimes, micros() - start_us);
+
+  if ((millis() - lastPrint_ms) > PRINT_INTERVAL_ms) {
+    lastPrint_ms = millis();
+    Serial.print("Free heap after start:"); Serial.println(startupFreeHeap);
+    printTimes("web", webTimes);
+    printTimes("app", appTimes);
+  }
+}
@@ -0,0 +1,363 @@
+/*
+   pfodReplay.js
+ * (c)2025 Forward Computing and Control Pty. Ltd.
+ * NSW Australia, www.forward.com.au
+ * This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+ * This generated code may be freely used for both private and commercial use
+ * provided this copyright is maintained.
+ */
+
+// Replays a capture made with ESP32_start_pfodCapture() and reports the
+// throughput, latency distribution and reply size per command type.
+// Needs only node, no other packages.
+//
+// Usage
+//   node pfodReplay.js capture.bin --info
+//       summary of the captured cmds and latencies, nothing sent
+//   node pfodReplay.js capture.bin --web=192.168.1.100 --app=192.168.1.100:4989 [--speed=1] [--json]
+//       replays the pfodWeb cmds as http GET /pfodWeb?cmd=... to --web
+//       and the pfodApp cmds over tcp to --app, one connection per captured slot
+//       --speed=1 original timing, --speed=10 ten times faster, --speed=0 as fast as possible
+//       --json prints the results as json, e.g. to save with the capture as a benchmark
+// --web can also be a pfodWebServer.js running with --proxy, e.g. --web=localhost:8080/device/192.168.1.100
+
+const fs = require('fs');
+const http = require('http');
+const net = require('net');
+
+const SOURCE_WEB = 1;
+const SOURCE_APP = 2;
+const HAS_REPLY = 0x80;
+
+function getArg(name) {
+  for (const arg of process.argv.slice(2)) {
+    if (arg === `--${name}`) {
+      return 'true';
+    }
+    if (arg.startsWith(`--${name}=`)) {
+      return arg.substring(name.length + 3);
+    }
+  }
+  return undefined;
+}
+
+function readCapture(fileName) {
+  const buf = fs.readFileSync(fileName);
+  if ((buf.length < 12) || (buf.toString('latin1', 0, 7) !== 'pfodCAP')) {
+    throw new Error(`${fileName} is not a pfodCapture file`);
+  }
+  const formatVersion = buf[7];
+  if (formatVersion !== 1) {
+    throw new Error(`${fileName} capture format version ${formatVersion} not supported`);
+  }
+  const records = [];
+  let pos = 12;
+  while (pos + 16 <= buf.length) {
+    const sourceByte = buf[pos];
+    const record = {
+      source: sourceByte & ~HAS_REPLY,
+      slot: buf[pos + 1],
+      time_ms: buf.readUInt32LE(pos + 2),
+      duration_us: buf.readUInt32LE(pos + 6),
+      replyLen: buf.readUInt32LE(pos + 12),
+      cmd: '',
+      reply: null
+    };
+    const cmdLen = buf.readUInt16LE(pos + 10);
+    pos += 16;
+    record.cmd = buf.toString('latin1', pos, pos + cmdLen);
+    pos += cmdLen;
+    if (sourceByte & HAS_REPLY) {
+      record.reply = buf.toString('latin1', pos, pos + record.replyLen);
+      pos += record.replyLen;
+    }
+    if (pos > buf.length) {
+      console.log(`Capture truncated after ${records.length} records`);
+      break;
+    }
+    records.push(record);
+  }
+  return records;
+}
+
+// cmd type used to group the results
+function cmdType(record) {
+  const source = (record.source === SOURCE_WEB) ? 'web' : 'app';
+  const inner = record.cmd.trim().replace(/^\{/, '').replace(/\}$/, '');
+  let type;
+  if ((inner === '.') || inner.endsWith(':.')) {
+    type = 'mainMenu';
+  } else if (inner.includes('~')) {
+    type = 'touch';
+  } else if ((inner === '!') || (inner === '@')) {
+    type = inner;
+  } else if (inner.includes(':')) {
+    type = 'dwgRefresh'; // {version:dwgName}
+  } else if (inner.length === 1) {
+    type = 'menuCmd';
+  } else {
+    type = 'dwgLoad';
+  }
+  return `${source}:${type}`;
+}
+
+function percentile(sorted, p) {
+  if (sorted.length === 0) {
+    return 0;
+  }
+  const idx = Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1);
+  return sorted[Math.max(0, idx)];
+}
+
+// results is array of { type, latency_ms, bytes }
+function summarize(results) {
+  const byType = new Map();
+  for (const result of results) {
+    if (!byType.has(result.type)) {
+      byType.set(result.type, []);
+    }
+    byType.get(result.type).push(result);
+  }
+  const summary = {};
+  for (const [type, list] of [...byType].sort()) {
+    const latencies = list.map(r => r.latency_ms).sort((a, b) => a - b);
+    const bytes = list.reduce((total, r) => total + r.bytes, 0);
+    summary[type] = {
+      count: list.length,
+      errors: list.filter(r => r.error).length,
+      p50_ms: +percentile(latencies, 50).toFixed(2),
+      p90_ms: +percentile(latencies, 90).toFixed(2),
+      p99_ms: +percentile(latencies, 99).toFixed(2),
+      max_ms: +latencies[latencies.length - 1].toFixed(2),
+      avgBytes: Math.round(bytes / list.length)
+    };
+  }
+  return summary;
+}
+
+function printSummary(title, summary) {
+  console.log(title);
+  console.log('type                 count errors  p50ms  p90ms  p99ms  maxms avgBytes');
+  for (const [type, s] of Object.entries(summary)) {
+    console.log(`${type.padEnd(20)} ${String(s.count).padStart(5)} ${String(s.errors).padStart(6)} ` +
+      `${s.p50_ms.toFixed(1).padStart(6)} ${s.p90_ms.toFixed(1).padStart(6)} ${s.p99_ms.toFixed(1).padStart(6)} ` +
+      `${s.max_ms.toFixed(1).padStart(6)} ${String(s.avgBytes).padStart(8)}`);
+  }
+}
+
+function capturedResults(records) {
+  return records.map(record => ({
+    type: cmdType(record),
+    latency_ms: record.duration_us / 1000,
+    bytes: record.replyLen
+  }));
+}
+
+// host, host:port or host:port/path prefix
+function parseTarget(target, defaultPort) {
+  const slash = target.indexOf('/');
+  const hostPort = (slash >= 0) ? target.substring(0, slash) : target;
+  const prefix = (slash >= 0) ? target.substring(slash) : '';
+  const [host, port] = hostPort.split(':');
+  return { host: host, port: port ? parseInt(port, 10) : defaultPort, prefix: prefix };
+}
+
+function sendWeb(target, agent, cmd) {
+  return new Promise((resolve, reject) => {
+    const req = http.get({
+      host: target.host,
+      port: target.port,
+      path: `${target.prefix}/pfodWeb?cmd=${encodeURIComponent(cmd)}`,
+      agent: agent
+    }, (res) => {
+      let bytes = 0;
+      res.on('data', chunk => { bytes += chunk.length; });
+      res.on('end', () => resolve(bytes));
+      res.on('error', reject);
+    });
+    req.setTimeout(10000, () => req.destroy(new Error('timed out')));
+    req.on('error', reject);
+  });
+}
+
+// one tcp connection per captured slot, replies end at the closing } of the pfod msg
+class AppConnection {
+  constructor(target) {
+    this.target = target;
+    this.socket = null;
+    this.pending = null;
+  }
+
+  connect() {
+    return new Promise((resolve, reject) => {
+      this.socket = net.connect(this.target.port, this.target.host, resolve);
+      this.socket.setNoDelay(true);
+      this.socket.on('error', (error) => {
+        if (this.pending) {
+          this.pending.reject(error);
+          this.pending = null;
+        } else {
+          reject(error);
+        }
+      });
+      this.socket.on('data', (data) => this.onData(data));
+      this.socket.on('close', () => {
+        this.socket = null; // reconnect on next cmd
+        if (this.pending) {
+          this.pending.reject(new Error('connection closed'));
+          this.pending = null;
+        }
+      });
+    });
+  }
+
+  onData(data) {
+    if (!this.pending) {
+      return;
+    }
+    for (const c of data) {
+      this.pending.bytes++;
+      if (c === 0x7B) { // {
+        this.pending.depth++;
+      } else if ((c === 0x7D) && (this.pending.depth > 0)) { // }
+        this.pending.depth--;
+        if (this.pending.depth === 0) {
+          const pending = this.pending;
+          this.pending = null;
+          pending.resolve(pending.bytes);
+          return;
+        }
+      }
+    }
+  }
+
+  async send(cmd) {
+    if (!this.socket) {
+      await this.connect();
+    }
+    return new Promise((resolve, reject) => {
+      const timer = setTimeout(() => {
+        if (this.pending) {
+          this.pending = null;
+          reject(new Error('timed out'));
+        }
+      }, 10000);
+      this.pending = {
+        resolve: (bytes) => { clearTimeout(timer); resolve(bytes); },
+        reject: (error) => { clearTimeout(timer); reject(error); },
+        bytes: 0, depth: 0
+      };
+      this.socket.write(cmd, 'latin1');
+    });
+  }
+
+  close() {
+    if (this.socket) {
+      this.socket.end();
+    }
+  }
+}
+
+async function replay(records, webTarget, appTarget, speed) {
+  const results = [];
+  const webAgent = new http.Agent({ keepAlive: false, maxSockets: 1 }); // device handles one request at a time
+  const appConnections = new Map(); // slot -> AppConnection
+  const queues = new Map(); // web or app slot -> Promise chain, keeps each connection's cmds in order
+  const startTime = Date.now();
+
+  const sendRecord = async (record) => {
+    const type = cmdType(record);
+    const sentAt = process.hrtime.bigint();
+    try {
+      let bytes;
+      if (record.source === SOURCE_WEB) {
+        bytes = await sendWeb(webTarget, webAgent, record.cmd);
+      } else {
+        let connection = appConnections.get(record.slot);
+        if (!connection) {
+          connection = new AppConnection(appTarget);
+          appConnections.set(record.slot, connection);
+        }
+        bytes = await connection.send(record.cmd);
+      }
+      results.push({ type: type, latency_ms: Number(process.hrtime.bigint() - sentAt) / 1e6, bytes: bytes });
+    } catch (error) {
+      results.push({ type: type, latency_ms: Number(process.hrtime.bigint() - sentAt) / 1e6, bytes: 0, error: error.message });
+    }
+  };
+
+  for (const record of records) {
+    if ((record.source === SOURCE_WEB) && !webTarget) {
+      continue;
+    }
+    if ((record.source === SOURCE_APP) && !appTarget) {
+      continue;
+    }
+    const queueKey = (record.source === SOURCE_WEB) ? 'web' : `app${record.slot}`;
+    const previous = queues.get(queueKey) || Promise.resolve();
+    let next;
+    if (speed > 0) {
+      const due = startTime + (record.time_ms / speed);
+      next = previous.then(() => new Promise(resolve => setTimeout(resolve, Math.max(0, due - Date.now()))))
+        .then(() => sendRecord(record));
+    } else {
+      next = previous.then(() => sendRecord(record));
+    }
+    queues.set(queueKey, next);
+  }
+  await Promise.all(queues.values());
+  const elapsed_ms = Date.now() - startTime;
+  for (const connection of appConnections.values()) {
+    connection.close();
+  }
+  return { results: results, elapsed_ms: elapsed_ms };
+}
+
+async function main() {
+  const fileName = process.argv.slice(2).find(arg => !arg.startsWith('--'));
+  if (!fileName) {
+    console.log('Usage: node pfodReplay.js capture.bin [--info] [--web=ip[:port]] [--app=ip[:port]] [--speed=1] [--json]');
+    process.exit(1);
+  }
+  const records = readCapture(fileName);
+  const captured = summarize(capturedResults(records));
+  const web = getArg('web');
+  const app = getArg('app');
+  const json = getArg('json');
+
+  if (getArg('info') || (!web && !app)) {
+    if (json) {
+      console.log(JSON.stringify({ records: records.length, captured: captured }, null, 2));
+    } else {
+      const duration_ms = records.reduce((max, record) => Math.max(max, record.time_ms), 0);
+      console.log(`${fileName}: ${records.length} records over ${(duration_ms / 1000).toFixed(1)}s`);
+      printSummary('Captured', captured);
+    }
+    return;
+  }
+
+  const speedArg = getArg('speed');
+  const speed = (speedArg === undefined) ? 1 : parseFloat(speedArg);
+  const webTarget = web ? parseTarget(web, 80) : null;
+  const appTarget = app ? parseTarget(app, 4989) : null;
+  const { results, elapsed_ms } = await replay(records, webTarget, appTarget, speed);
+  const replayed = summarize(results);
+  const throughput = results.length / (elapsed_ms / 1000);
+
+  if (json) {
+    console.log(JSON.stringify({
+      records: records.length, sent: results.length, speed: speed, elapsed_ms: elapsed_ms,
+      cmdsPerSec: +throughput.toFixed(2), replayed: replayed, captured: captured
+    }, null, 2));
+  } else {
+    console.log(`Replayed ${results.length} of ${records.length} cmds in ${(elapsed_ms / 1000).toFixed(2)}s ` +
+      `(speed ${speed === 0 ? 'max' : speed + 'x'}), ${throughput.toFixed(1)} cmds/sec`);
+    printSummary('Replayed', replayed);
+    printSummary('Captured', captured);
+  }
+}
+
+main().catch((error) => {
+  console.log(error.message);
+  process.exit(1);
+});
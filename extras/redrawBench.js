@@ -0,0 +1,157 @@
+/*
+   redrawBench.js
+ * (c)2025 Forward Computing and Control Pty. Ltd.
+ * NSW Australia, www.forward.com.au
+ * This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+ * This generated code may be freely used for both private and commercial use
+ * provided this copyright is maintained.
+ */
+
+// Microbenchmark of the pfodWeb label and value drawing on a 500 label drawing.
+// Loads displayTextUtils.js and redraw.js into a node vm with logging off and a stub 2d context,
+// then draws 250 underlined labels and 250 underlined values per frame, changing 5 values each frame.
+// Each frame every item is copied first, as MergeAndRedraw does on each merge, and drawn via drawItem()
+// Needs only node, no other packages.
+//
+// Usage
+//   node redrawBench.js [--measureText-us=0] [dataDir ...]
+//       dataDir defaults to ../examples/pfodWeb_ESP32/data
+//       --measureText-us busy waits that long in each measureText call to model the browser's cost
+//       to compare with an earlier version
+//         git worktree add /tmp/pfodWebOld <commit>
+//         node extras/redrawBench.js examples/pfodWeb_ESP32/data /tmp/pfodWebOld/examples/pfodWeb_ESP32/data
+
+const fs = require('fs');
+const path = require('path');
+const vm = require('vm');
+
+const NUM_ITEMS = 500;
+const CHANGES_PER_FRAME = 5;
+const WARMUP_FRAMES = 50;
+const BATCHES = 5; // reports the fastest batch
+const FRAMES_PER_BATCH = 100;
+
+function loadRedraw(dataDir) {
+  const noLog = () => {};
+  const context = { console: { log: noLog, warn: noLog, error: noLog } };
+  context.window = context;
+  vm.createContext(context);
+  for (const file of ['displayTextUtils.js', 'redraw.js']) {
+    vm.runInContext(fs.readFileSync(path.join(dataDir, file), 'utf8'), context, { filename: file });
+  }
+  return context;
+}
+
+// counts measureText calls, width is a cheap function of the text
+function stubContext(measureText_us) {
+  const ctx = {
+    measureTextCalls: 0,
+    measureText(text) {
+      this.measureTextCalls++;
+      if (measureText_us > 0) {
+        const end = process.hrtime.bigint() + BigInt(Math.round(measureText_us * 1000));
+        while (process.hrtime.bigint() < end) {
+        }
+      }
+      let width = 0;
+      for (let i = 0; i < text.length; i++) {
+        width += (text.charCodeAt(i) % 7) + 3;
+      }
+      return { width: width };
+    }
+  };
+  for (const fn of ['save', 'restore', 'beginPath', 'rect', 'clip', 'fillText', 'moveTo', 'lineTo', 'stroke', 'fill', 'fillRect', 'strokeRect']) {
+    ctx[fn] = () => {};
+  }
+  return ctx;
+}
+
+// the per drawing items as received, idx 1..NUM_ITEMS, alternating labels and values
+function makeItems() {
+  const items = [];
+  for (let i = 0; i < NUM_ITEMS; i++) {
+    const item = {
+      idx: i + 1,
+      xOffset: i % 25,
+      yOffset: Math.floor(i / 25) * 5,
+      fontSize: i % 5,
+      underline: 'true',
+      align: ['left', 'center', 'right'][i % 3],
+      color: i % 16,
+      transform: { x: 0, y: 0, scale: 1 },
+      clipRegion: { x: 0, y: 0, width: 255, height: 255 }
+    };
+    if (i % 2) {
+      Object.assign(item, { type: 'label', text: `Label ${i}\nline 2 `, value: String(i * 1.5), decimals: 2, units: ' V' });
+    } else {
+      Object.assign(item, { type: 'value', text: `Val ${i} `, intValue: String(i), max: 1023, min: 0, displayMax: 3.3, displayMin: 0, decimals: 2, units: 'V' });
+    }
+    items.push(item);
+  }
+  return items;
+}
+
+function run(dataDir, measureText_us) {
+  const context = loadRedraw(dataDir);
+  // count the label/value texts actually generated, i.e. not found in a memo
+  let textsGenerated = 0;
+  const generateItemDisplayText = context.generateItemDisplayText;
+  if (generateItemDisplayText) {
+    context.generateItemDisplayText = (item) => {
+      textsGenerated++;
+      return generateItemDisplayText(item);
+    };
+  }
+  const redraw = new context.Redraw();
+  const ctx = stubContext(measureText_us);
+  redraw.canvas = { width: 765, height: 765, scaleX: 3, scaleY: 3 };
+  redraw.ctx = ctx;
+  const items = makeItems();
+  let changeCount = 0;
+  const frame = () => {
+    for (let k = 0; k < CHANGES_PER_FRAME; k++) {
+      const item = items[(changeCount++ * 97) % NUM_ITEMS];
+      if (item.type === 'value') {
+        item.intValue = String(changeCount % 1024);
+      } else {
+        item.value = String(changeCount / 10);
+      }
+    }
+    for (const item of items) {
+      redraw.drawItem({ ...item }); // new merged copy each frame
+    }
+  };
+  for (let i = 0; i < WARMUP_FRAMES; i++) {
+    frame();
+  }
+  const startCalls = ctx.measureTextCalls;
+  const startTexts = textsGenerated;
+  let ms = Infinity;
+  for (let batch = 0; batch < BATCHES; batch++) {
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < FRAMES_PER_BATCH; i++) {
+      frame();
+    }
+    ms = Math.min(ms, Number(process.hrtime.bigint() - start) / 1e6 / FRAMES_PER_BATCH);
+  }
+  const frames = BATCHES * FRAMES_PER_BATCH;
+  const calls = (ctx.measureTextCalls - startCalls) / frames;
+  const texts = generateItemDisplayText ? ((textsGenerated - startTexts) / frames).toFixed(1) : 'n/a';
+  console.log(`${dataDir}: ${ms.toFixed(3)} ms/frame, ${calls.toFixed(1)} measureText calls/frame, ${texts} display texts generated/frame`);
+}
+
+let measureText_us = 0;
+const dataDirs = [];
+for (const arg of process.argv.slice(2)) {
+  if (arg.startsWith('--measureText-us=')) {
+    measureText_us = parseFloat(arg.substring('--measureText-us='.length)) || 0;
+  } else {
+    dataDirs.push(arg);
+  }
+}
+if (dataDirs.length === 0) {
+  dataDirs.push(path.join(__dirname, '..', 'examples', 'pfodWeb_ESP32', 'data'));
+}
+for (const dataDir of dataDirs) {
+  run(dataDir, measureText_us);
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+#  sizeReport.sh
+#  (c)2025 Forward Computing and Control Pty. Ltd.
+#  NSW Australia, www.forward.com.au
+#  This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+#  This generated code may be freely used for both private and commercial use
+#  provided this copyright is maintained.
+#
+# Compiles a sketch from the current tree against two git revisions of this library
+# and prints the flash and RAM arduino-cli reports for each.
+# The default sketch, extras/dispatchTiming, uses both default servers and, unlike the pfodWeb_ESP32 example,
+# needs no drawing added to link. Upload each build to compare their dispatch times, see dispatchTiming.ino
+# Needs git, and arduino-cli with the esp32 core and the pfodParser library installed.
+#
+# Usage, from anywhere in the repository
+#   extras/sizeReport.sh [beforeRev] [afterRev] [fqbn] [sketchDir]
+#   beforeRev defaults to the commit before the template servers were added
+#   afterRev defaults to HEAD, fqbn to esp32:esp32:esp32, sketchDir to extras/dispatchTiming
+#
+# The default servers used by the sketch moved from globals and new'd parsers to
+# function-local statics, so "Global variables" includes parsers that were previously on the heap.
+# Compare the free heap printed at startup as well.
+
+set -e
+
+# the first, oldest, [user-027] commit, later ones are fixes on top of the template servers
+BEFORE=${1:-"$(git log --reverse --format=%h --grep='^\[user-027\]' | head -1)^"}
+AFTER=${2:-HEAD}
+FQBN=${3:-esp32:esp32:esp32}
+SKETCH=${4:-extras/dispatchTiming}
+
+REPO=$(git rev-parse --show-toplevel)
+SKETCH=$(cd "$SKETCH" 2>/dev/null || cd "$REPO/$SKETCH"; pwd)
+SKETCH_NAME=$(basename "$SKETCH")
+WORK=$(mktemp -d)
+trap 'git -C "$REPO" worktree remove --force "$WORK/before" 2>/dev/null; git -C "$REPO" worktree remove --force "$WORK/after" 2>/dev/null; rm -rf "$WORK"' EXIT
+
+for NAME in before after; do
+  if [ "$NAME" = before ]; then REV=$BEFORE; else REV=$AFTER; fi
+  git -C "$REPO" worktree add --detach --quiet "$WORK/$NAME" "$REV"
+  # the sketch directory name must match the .ino
+  mkdir -p "$WORK/sketch_$NAME"
+  cp -r "$SKETCH" "$WORK/sketch_$NAME/"
+  echo "$NAME $(git -C "$REPO" log --format='%h %s' -1 "$REV")"
+  arduino-cli compile --fqbn "$FQBN" --library "$WORK/$NAME" "$WORK/sketch_$NAME/$SKETCH_NAME" 2>&1 | grep -E 'Sketch uses|Global variables|[Ee]rror'
+done
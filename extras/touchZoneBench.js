@@ -0,0 +1,141 @@
+/*
+   touchZoneBench.js
+ * (c)2025 Forward Computing and Control Pty. Ltd.
+ * NSW Australia, www.forward.com.au
+ * This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+ * This generated code may be freely used for both private and commercial use
+ * provided this copyright is maintained.
+ */
+
+// Benchmark of pfodWebMouse findTouchZoneAt() with 1000 touchZones, with and without the TouchZoneIndex.
+// Loads drawingDataProcessor.js, mergeAndRedraw.js and pfodWebMouse.js into a node vm with logging off.
+// The touchZones are 100 inserted dwgs of 10 zones each, some centered, some disabled, some with an idx,
+// plus a whole dwg touchZone over them all and one with a numeric cmd.
+// Without touchActionBackups.touchZoneIndex findTouchZoneAt() checks every touchZone, as it did before the index,
+// so the two runs also check that the index picks the same touchZone at every point. Exits with 1 if not.
+// Needs only node, no other packages.
+//
+// Usage
+//   node touchZoneBench.js [dataDir] [--points=2000]
+//       dataDir defaults to ../examples/pfodWeb_ESP32/data
+
+const fs = require('fs');
+const path = require('path');
+const vm = require('vm');
+
+const DWG_SIZE = 255;
+const TOUCH_EXTRA = 4; // dwg coords added to each side of the touchZones, as for the 9mm minimum touch size
+const BATCHES = 5; // reports the fastest batch
+
+function load(dataDir) {
+  const noLog = () => {};
+  const context = { console: { log: noLog, warn: noLog, error: noLog } };
+  context.window = context;
+  vm.createContext(context);
+  context.Redraw = function() {}; // MergeAndRedraw is not constructed
+  for (const file of ['drawingDataProcessor.js', 'mergeAndRedraw.js', 'pfodWebMouse.js']) {
+    vm.runInContext(fs.readFileSync(path.join(dataDir, file), 'utf8'), context, { filename: file });
+  }
+  return context;
+}
+
+// repeatable pseudo random numbers 0 <= r < 1
+let seed = 1;
+function random() {
+  seed = (seed * 1103515245 + 12345) % 2147483648;
+  return seed / 2147483648;
+}
+
+function makeTouchZones(filters) {
+  const allTouchZonesByCmd = {};
+  for (let dwg = 0; dwg < 100; dwg++) {
+    // each inserted dwg is 250 x 250 scaled to 25 x 25
+    const transform = { x: (dwg % 10) * 25, y: Math.floor(dwg / 10) * 25, scale: 0.1 };
+    for (let i = 0; i < 10; i++) {
+      const cmd = 'c' + (dwg * 10 + i);
+      allTouchZonesByCmd[cmd] = {
+        type: 'touchZone',
+        cmd: cmd,
+        xOffset: (i % 5) * 50,
+        yOffset: Math.floor(i / 5) * 120,
+        xSize: 45,
+        ySize: 100,
+        filter: (random() < 0.05) ? filters.TOUCH_DISABLED : filters.DOWN,
+        idx: (random() < 0.2) ? 1 : 0,
+        centered: (random() < 0.3) ? 'true' : undefined,
+        transform: transform
+      };
+    }
+  }
+  allTouchZonesByCmd['all'] = { type: 'touchZone', cmd: 'all', xOffset: 0, yOffset: 0, xSize: 250, ySize: 250, filter: filters.DOWN, transform: { x: 0, y: 0, scale: 1 } };
+  allTouchZonesByCmd['7'] = { type: 'touchZone', cmd: '7', xOffset: 10, yOffset: 10, xSize: 5, ySize: 5, filter: filters.DOWN, transform: { x: 0, y: 0, scale: 1 } };
+  return allTouchZonesByCmd;
+}
+
+let dataDir = path.join(__dirname, '..', 'examples', 'pfodWeb_ESP32', 'data');
+let numPoints = 2000;
+for (const arg of process.argv.slice(2)) {
+  if (arg.startsWith('--points=')) {
+    numPoints = parseInt(arg.substring('--points='.length)) || numPoints;
+  } else {
+    dataDir = arg;
+  }
+}
+
+const context = load(dataDir);
+const mouse = context.pfodWebMouse;
+const allTouchZonesByCmd = makeTouchZones(context.TouchZoneFilters);
+const numZones = Object.keys(allTouchZonesByCmd).length;
+
+// built the same way MergeAndRedraw builds it while merging
+let buildStart = process.hrtime.bigint();
+const touchZoneIndex = context.TouchZoneIndex.forDrawingSize(DWG_SIZE, DWG_SIZE);
+for (const cmd in allTouchZonesByCmd) {
+  touchZoneIndex.set(cmd, allTouchZonesByCmd[cmd]);
+}
+const build_ms = Number(process.hrtime.bigint() - buildStart) / 1e6;
+
+const points = [];
+for (let i = 0; i < numPoints; i++) {
+  points.push([random() * (DWG_SIZE + 10) - 5, random() * (DWG_SIZE + 10) - 5]);
+}
+const viewer = { mergeAndRedraw: {}, touchState: { isDown: true } };
+const indexed = { allTouchZonesByCmd: allTouchZonesByCmd, touchZoneIndex: touchZoneIndex };
+const linear = { allTouchZonesByCmd: allTouchZonesByCmd };
+
+function findAll(backups) {
+  mouse.touchActionBackups = backups;
+  return points.map(([x, y]) => mouse.findTouchZoneAt.call(viewer, x, y, TOUCH_EXTRA, TOUCH_EXTRA));
+}
+
+function time_us(backups) {
+  let best = Infinity;
+  for (let batch = 0; batch < BATCHES; batch++) {
+    const start = process.hrtime.bigint();
+    findAll(backups);
+    best = Math.min(best, Number(process.hrtime.bigint() - start) / 1e3 / points.length);
+  }
+  return best;
+}
+
+const linearZones = findAll(linear);
+const indexedZones = findAll(indexed);
+let mismatches = 0;
+let found = 0;
+for (let i = 0; i < points.length; i++) {
+  const linearCmd = linearZones[i] ? linearZones[i].cmd : null;
+  const indexedCmd = indexedZones[i] ? indexedZones[i].cmd : null;
+  if (linearCmd !== indexedCmd) {
+    mismatches++;
+    if (mismatches <= 5) {
+      console.log(`mismatch at (${points[i][0]}, ${points[i][1]}) all zones: ${linearCmd} index: ${indexedCmd}`);
+    }
+  }
+  if (linearCmd) {
+    found++;
+  }
+}
+console.log(`${numZones} touchZones, ${points.length} points, ${found} in a touchZone, ${mismatches} mismatches`);
+console.log(`index build ${build_ms.toFixed(2)} ms, ${touchZoneIndex.cells.size} cells, ${touchZoneIndex.largeEntries.length} large touchZones`);
+console.log(`findTouchZoneAt all zones ${time_us(linear).toFixed(2)} us, with index ${time_us(indexed).toFixed(2)} us`);
+process.exitCode = (mismatches === 0) ? 0 : 1;
@@ -8,7 +8,6 @@
 */
 
 #include "ESP32_pfodAppServer.h"
-#include <pfodParser.h>
 // This library needs handle_pfodMainMenu to be defined in the sketch
 extern void handle_pfodMainMenu(pfodParser & parser);
 
@@ -18,73 +17,70 @@ extern void handle_pfodMainMenu(pfodParser & parser);
 // or just used debugPtr = &Serial 
 static Print* debugPtr = &Serial; //NULL; // &Serial  // local to this file
 
-#include <WiFi.h>
-#include <WiFiClient.h>
-// pfodESPBufferedClient included in pfodParser library
-#include <pfodESPBufferedClient.h>
+ESP32_pfodAppServerBase *ESP32_pfodAppServerBase::first = NULL;
 
-pfodParser parser; // always have this one // create a parser with menu version string to handle the pfod messages
-void closeConnection(Stream * io);
-pfodESPBufferedClient bufferedClient;
-
-static const uint8_t MAX_CLIENTS = 4; // the default MUST BE AT LEAST 1 !!
-static WiFiClient clients[MAX_CLIENTS]; // hold the currently open clients
-static pfodParser *parserPtrs[MAX_CLIENTS]; // hold the parsers for each client
-static pfodESPBufferedClient *bufferedClientPtrs[MAX_CLIENTS]; // hold the parsers for each client
+// default server only constructed if ESP32_start_pfodAppServer() etc are used
+static ESP32_pfodAppServer<>& defaultServer() {
+  static ESP32_pfodAppServer<> server;
+  return server;
+}
 
-static const int portNo = 4989; // What TCP port to listen on for connections.
+ESP32_pfodAppServerBase::ESP32_pfodAppServerBase(uint16_t _portNo, uint8_t _maxClients, WiFiClient *_clients, pfodParser *_parsers)
+  : server(_portNo), portNo(_portNo), maxClients(_maxClients), clients(_clients), parsers(_parsers) {
+  bufferedClients = NULL;
+  captureStreams = NULL;
+  msgClients = NULL;
+  handler = handle_pfodMainMenu;
+  serverStarted = false;
+  // add to list of servers
+  next = first;
+  first = this;
+}
 
-static WiFiServer server(portNo);
-static WiFiClient client;
-static bool serverStarted = false;
-static bool parsersInitialized = false;
+void ESP32_pfodAppServerBase::setClientStreams(pfodESPBufferedClient *_bufferedClients, ESP32_pfodCaptureStream *_captureStreams, ESP32_pfodMsgClient *_msgClients) {
+  bufferedClients = _bufferedClients;
+  captureStreams = _captureStreams;
+  msgClients = _msgClients;
+}
 
-static void initParsers() {
-  if (parsersInitialized) {
-    return;
-  }
-  // always have at least one
-  parserPtrs[0] = &parser;
-  bufferedClientPtrs[0] = &bufferedClient;
-
-  // fill in the rest
-  for (size_t i = 1; i < MAX_CLIENTS; i++) {
-    parserPtrs[i] = new pfodParser();
-    bufferedClientPtrs[i] = new pfodESPBufferedClient();
+void ESP32_pfodAppServerBase::setHandler(void (*_handler)(pfodParser & parser)) {
+  if (_handler) {
+    handler = _handler;
   }
-  parsersInitialized = true;
 }
 
-void pfodApp_setVersion(const char* version) {
-  initParsers();
-  for (size_t i=0; i< MAX_CLIENTS; i++) {
-   parserPtrs[i]->setVersion(version);
+void ESP32_pfodAppServerBase::setVersion(const char* version) {
+  for (size_t i = 0; i < maxClients; i++) {
+    parsers[i].setVersion(version);
   }
-}  
+}
 
-void ESP32_start_pfodAppServer(const char* version) {
+void ESP32_pfodAppServerBase::start(const char* version) {
   if (serverStarted) {
     return;
   }
-  pfodApp_setVersion(version); // calls  initParsers();
+  setVersion(version);
   // Start the server
   server.begin();
   Serial.println("pfodApp Server started");
   // Print the IP address
   Serial.print(" on ");
   Serial.print(WiFi.localIP());
-  Serial.print(":"); debugPtr->println(portNo);
+  Serial.print(":"); Serial.print(portNo);
+  if (msgClients) {
+    Serial.print(" low latency");
+  }
+  Serial.println();
   serverStarted = true;
 }
 
-bool validClient(WiFiClient & client) {
+bool ESP32_pfodAppServerBase::validClient(WiFiClient & client) {
   return (client.connected());
 }
 
-
-void ESP32_handle_pfodAppServer() {
+void ESP32_pfodAppServerBase::handle() {
   if (!serverStarted) {
-    Serial.println("Error: pfodApp server not started.  Call ESP32_start_pfodAppServer() from setup()");
+    Serial.println("Error: pfodApp server not started.  Call start() from setup()");
     return;
   }
   if (server.hasClient()) { // new connection
@@ -93,11 +89,18 @@ void ESP32_handle_pfodAppServer() {
     }
     bool foundSlot = false;
     size_t i = 0;
-    for (; i < MAX_CLIENTS; i++) {
+    for (; i < maxClients; i++) {
       if (!validClient(clients[i])) { // this space if free
         foundSlot = true;
         clients[i] = server.accept(); // was previously server.available();
-        parserPtrs[i]->connect(bufferedClientPtrs[i]->connect(&(clients[i]))); // sets new io stream to read from and write to
+        if (msgClients) {
+          parsers[i].connect(msgClients[i].connect(&(clients[i]))); // sets new io stream to read from and write to
+        } else if (captureStreams && pfodCapture_isActive()) {
+          // capture stream records cmds and reply lengths, only used for connections accepted while capturing
+          parsers[i].connect(captureStreams[i].connect(bufferedClients[i].connect(&(clients[i])))); // sets new io stream to read from and write to
+        } else {
+          parsers[i].connect(bufferedClients[i].connect(&(clients[i]))); // sets new io stream to read from and write to
+        }
         break;
       }
     }
@@ -113,13 +116,88 @@ void ESP32_handle_pfodAppServer() {
       }
     }
   }
-  for (size_t i = 0; i < MAX_CLIENTS; i++) {
+  for (size_t i = 0; i < maxClients; i++) {
     if (validClient(clients[i])) {
-      handle_pfodMainMenu(*parserPtrs[i]);
+      if (msgClients) {
+        if (msgClients[i].isBusy()) {
+          continue; // slow reader, don't parse more cmds until the last reply has gone
+        }
+        handler(parsers[i]);
+        msgClients[i].flush(); // send anything not terminated by }
+      } else {
+        handler(parsers[i]);
+      }
+    }
+  }
+}
+
+const ESP32_pfodMsgClientStats* ESP32_pfodAppServerBase::getStats(uint8_t slot) {
+  if ((!msgClients) || (slot >= maxClients)) {
+    return NULL;
+  }
+  return &(msgClients[slot].getStats());
+}
+
+void ESP32_pfodAppServerBase::printStats(Print & out) {
+  if (!msgClients) {
+    out.println("No stats, TxBufSize is 0");
+    return;
+  }
+  for (size_t i = 0; i < maxClients; i++) {
+    if (!validClient(clients[i])) {
+      continue;
     }
+    const ESP32_pfodMsgClientStats& stats = msgClients[i].getStats();
+    out.print(portNo); out.print(':'); out.print(i);
+    out.print(" replies:"); out.print(stats.replies);
+    if (stats.replies) {
+      out.print(" latency us last:"); out.print(stats.lastLatency_us);
+      out.print(" min:"); out.print(stats.minLatency_us);
+      out.print(" avg:"); out.print((uint32_t)(stats.totalLatency_us / stats.replies));
+      out.print(" max:"); out.print(stats.maxLatency_us);
+    }
+    out.print(" maxSend us:"); out.print(stats.maxSendTime_us);
+    out.print(" partialSends:"); out.print(stats.partialSends);
+    out.print(" droppedBytes:"); out.println(stats.droppedBytes);
   }
 }
 
+bool ESP32_pfodAppServerBase::closeConnection(Stream * io) {
+  for (size_t i = 0; i < maxClients; i++) {
+    if ((parsers[i].getPfodAppStream() == io) && validClient(clients[i])) {
+      if (debugPtr) {
+        debugPtr->print(portNo); debugPtr->print(':'); debugPtr->println(i);
+      }
+      // found match
+      parsers[i].closeConnection(); // nulls io stream
+      if (msgClients) {
+        msgClients[i].stop(); // clears client reference
+      } else {
+        if (captureStreams) {
+          captureStreams[i].stop();
+        }
+        bufferedClients[i].stop(); // clears client reference
+      }
+      clients[i].stop();
+      return true;
+    }
+  }
+  return false;
+}
+
+void pfodApp_setVersion(const char* version) {
+  defaultServer().setVersion(version);
+}
+
+void ESP32_start_pfodAppServer(const char* version) {
+  defaultServer().start(version);
+}
+
+void ESP32_handle_pfodAppServer() {
+  defaultServer().handle();
+}
+
+// searches all the servers for this connection
 void closeConnection(Stream * io) {
   if (!io) {
     if (debugPtr) {
@@ -130,25 +208,12 @@ void closeConnection(Stream * io) {
   if (debugPtr) {
     debugPtr->print("closeConnection:");
   }
-  bool foundSlot = false;
-  size_t i = 0;
-  for (; i < MAX_CLIENTS; i++) {
-    if ((parserPtrs[i]->getPfodAppStream() == io) && validClient(clients[i])) {
-      foundSlot = true;
-      break;
+  for (ESP32_pfodAppServerBase *serverPtr = ESP32_pfodAppServerBase::first; serverPtr; serverPtr = serverPtr->next) {
+    if (serverPtr->closeConnection(io)) {
+      return;
     }
   }
-  if (foundSlot) {
-    if (debugPtr) {
-      debugPtr->println(i);
-    }
-    // found match
-    parserPtrs[i]->closeConnection(); // nulls io stream
-    bufferedClientPtrs[i]->stop(); // clears client reference
-    clients[i].stop();
-  } else {
-    if (debugPtr) {
-      debugPtr->println(" Connection stream NOT found");
-    }
+  if (debugPtr) {
+    debugPtr->println(" Connection stream NOT found");
   }
 }
@@ -1,7 +1,7 @@
 #ifndef ESP32_PFODAPP_SERVER_H
 #define ESP32_PFODAPP_SERVER_H
 #include <Arduino.h>
-/*   
+/*
    ESP32_pfodAppServer.h
  * (c)2025 Forward Computing and Control Pty. Ltd.
  * NSW Australia, www.forward.com.au
@@ -10,7 +10,139 @@
  * provided this copyright is maintained.
  */
 
+#include <WiFi.h>
+#include <WiFiClient.h>
+#include <pfodParser.h>
+// pfodESPBufferedClient included in pfodParser library
+#include <pfodESPBufferedClient.h>
+#include "ESP32_pfodMsgClient.h"
+#include "ESP32_pfodCapture.h"
+
+// uncomment this line to also capture the pfodApp cmds on TxBufSize 0 servers, see ESP32_pfodCapture.h
+// costs an ESP32_pfodCaptureStream, about 150 bytes, per connection
+//#define ESP32_PFOD_CAPTURE_BUFFERED_CLIENTS
+
+// default server, uses port 4989 and upto 4 pfodApp connections
+// This library needs handle_pfodMainMenu to be defined in the sketch
 void ESP32_start_pfodAppServer(const char* version);
 void ESP32_handle_pfodAppServer();
 void pfodApp_setVersion(const char* version);
+// closes the connection on any of the pfodApp servers
+void closeConnection(Stream * io);
+
+// All the code is in ESP32_pfodAppServerBase, the template just supplies the statically allocated slots
+// e.g.
+//   ESP32_pfodAppServer<4990, 2> secondServer; // port 4990, 2 connections
+//   ESP32_pfodAppServer<4991, 4, 1460> lowLatencyServer; // uses ESP32_pfodMsgClient with a 1460 byte tx buffer per connection
+//   in setup()  secondServer.start(version);
+//   in loop()   secondServer.handle();
+class ESP32_pfodAppServerBase {
+  public:
+    void start(const char* version);
+    void handle(); // call this each loop()
+    void setVersion(const char* version);
+    // defaults to handle_pfodMainMenu
+    void setHandler(void (*_handler)(pfodParser & parser));
+    // returns true if io was one of this server's connections, and closes it
+    bool closeConnection(Stream * io);
+    // reply latency stats for the connection in this slot, NULL if TxBufSize is 0 or slot not valid
+    const ESP32_pfodMsgClientStats* getStats(uint8_t slot);
+    void printStats(Print & out);
+
+  protected:
+    ESP32_pfodAppServerBase(uint16_t _portNo, uint8_t _maxClients, WiFiClient *_clients, pfodParser *_parsers);
+    // either bufferedClients or msgClients are NULL, captureStreams can be NULL, call before start()
+    void setClientStreams(pfodESPBufferedClient *_bufferedClients, ESP32_pfodCaptureStream *_captureStreams, ESP32_pfodMsgClient *_msgClients);
+
+  private:
+    friend void ::closeConnection(Stream * io);
+    ESP32_pfodAppServerBase(const ESP32_pfodAppServerBase&) = delete;
+    ESP32_pfodAppServerBase& operator=(const ESP32_pfodAppServerBase&) = delete;
+    bool validClient(WiFiClient & client);
+
+    WiFiServer server;
+    const uint16_t portNo;
+    const uint8_t maxClients;
+    WiFiClient *clients; // hold the currently open clients
+    pfodParser *parsers; // hold the parsers for each client
+    pfodESPBufferedClient *bufferedClients; // hold the bufferedClients for each client, NULL if msgClients used
+    ESP32_pfodCaptureStream *captureStreams; // between each parser and its bufferedClient while capturing, can be NULL
+    ESP32_pfodMsgClient *msgClients; // used instead of bufferedClients if not NULL
+    void (*handler)(pfodParser & parser);
+    bool serverStarted;
+    ESP32_pfodAppServerBase *next; // all the servers, searched by ::closeConnection()
+    static ESP32_pfodAppServerBase *first;
+};
+
+// the stream each connection is read from and written through, only one kind is allocated
+// TxBufSize 0 uses pfodESPBufferedClients, each behind an ESP32_pfodCaptureStream if ESP32_PFOD_CAPTURE_BUFFERED_CLIENTS,
+// otherwise ESP32_pfodMsgClients with a TxBufSize tx buffer each
+template<uint8_t MaxClients, size_t TxBufSize>
+class ESP32_pfodAppClientSlots {
+  public:
+    ESP32_pfodAppClientSlots() {
+      for (size_t i = 0; i < MaxClients; i++) {
+        msgClients[i].setBuffer(txBufs[i], TxBufSize);
+        msgClients[i].setSlot(i);
+      }
+    }
+    pfodESPBufferedClient* getBufferedClients() {
+      return NULL;
+    }
+    ESP32_pfodCaptureStream* getCaptureStreams() {
+      return NULL;
+    }
+    ESP32_pfodMsgClient* getMsgClients() {
+      return msgClients;
+    }
+  private:
+    ESP32_pfodMsgClient msgClients[MaxClients];
+    uint8_t txBufs[MaxClients][TxBufSize];
+};
+
+template<uint8_t MaxClients>
+class ESP32_pfodAppClientSlots<MaxClients, 0> {
+  public:
+    ESP32_pfodAppClientSlots() {
+#ifdef ESP32_PFOD_CAPTURE_BUFFERED_CLIENTS
+      for (size_t i = 0; i < MaxClients; i++) {
+        captureStreams[i].setSlot(i);
+      }
+#endif
+    }
+    pfodESPBufferedClient* getBufferedClients() {
+      return bufferedClients;
+    }
+    ESP32_pfodCaptureStream* getCaptureStreams() {
+#ifdef ESP32_PFOD_CAPTURE_BUFFERED_CLIENTS
+      return captureStreams;
+#else
+      return NULL;
+#endif
+    }
+    ESP32_pfodMsgClient* getMsgClients() {
+      return NULL;
+    }
+  private:
+    pfodESPBufferedClient bufferedClients[MaxClients];
+#ifdef ESP32_PFOD_CAPTURE_BUFFERED_CLIENTS
+    ESP32_pfodCaptureStream captureStreams[MaxClients];
+#endif
+};
+
+// TxBufSize > 0 turns on TCP_NODELAY and sends each pfod msg in one write, see ESP32_pfodMsgClient.h
+template<uint16_t PortNo = 4989, uint8_t MaxClients = 4, size_t TxBufSize = 0>
+class ESP32_pfodAppServer : public ESP32_pfodAppServerBase {
+    static_assert(MaxClients >= 1, "MaxClients MUST BE AT LEAST 1");
+    static_assert((TxBufSize == 0) || (TxBufSize >= ESP32_pfodMsgClient::MAX_PFOD_MSG_SIZE), "TxBufSize MUST BE 0 OR AT LEAST 1024, the largest pfod msg");
+  public:
+    ESP32_pfodAppServer() : ESP32_pfodAppServerBase(PortNo, MaxClients, clientSlots, parserSlots) {
+      setClientStreams(streamSlots.getBufferedClients(), streamSlots.getCaptureStreams(), streamSlots.getMsgClients());
+    }
+  private:
+    WiFiClient clientSlots[MaxClients];
+    pfodParser parserSlots[MaxClients];
+    ESP32_pfodAppClientSlots<MaxClients, TxBufSize> streamSlots;
+};
+
 #endif
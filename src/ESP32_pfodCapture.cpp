@@ -0,0 +1,239 @@
+/*
+   ESP32_pfodCapture.cpp
+   (c)2025 Forward Computing and Control Pty. Ltd.
+   NSW Australia, www.forward.com.au
+   This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+   This generated code may be freely used for both private and commercial use
+   provided this copyright is maintained.
+*/
+
+#include "ESP32_pfodCapture.h"
+#include "ESP32_LittleFSsupport.h"
+
+// debug control
+// see https://www.forward.com.au/pfod/ArduinoProgramming/Serial_IO/index.html  for how to used BufferedOutput
+// to prevent your sketch being held up by Serial
+// or just used debugPtr = &Serial
+static Print* debugPtr = NULL;  // local to this file
+
+static const uint8_t CAPTURE_VERSION = 1;
+static const uint32_t FLAG_REPLIES = 0x01;
+
+static bool captureActive = false;
+static bool captureReplies = false;
+static Print* captureOut = NULL; // points to captureFile when capturing to LittleFS
+static File captureFile;
+static size_t captureMaxBytes = 0; // 0 for no limit
+static size_t captureBytes = 0;
+static uint32_t captureStart_ms = 0;
+
+static void writeU16(uint16_t n) {
+  uint8_t buf[2] = { (uint8_t)n, (uint8_t)(n >> 8) };
+  captureOut->write(buf, sizeof(buf));
+}
+
+static void writeU32(uint32_t n) {
+  uint8_t buf[4] = { (uint8_t)n, (uint8_t)(n >> 8), (uint8_t)(n >> 16), (uint8_t)(n >> 24) };
+  captureOut->write(buf, sizeof(buf));
+}
+
+static void startCapture(Print* out, bool withReplies) {
+  captureOut = out;
+  captureReplies = withReplies;
+  captureBytes = 0;
+  captureStart_ms = millis();
+  captureOut->write((const uint8_t*)"pfodCAP", 7);
+  captureOut->write(CAPTURE_VERSION);
+  writeU32(captureReplies ? FLAG_REPLIES : 0);
+  captureBytes += 12;
+  captureActive = true;
+}
+
+bool ESP32_start_pfodCapture(const char* path, bool withReplies, size_t maxBytes) {
+  ESP32_stop_pfodCapture();
+  if (!initializeFS()) {
+    Serial.println("pfodCapture: LittleFS failed to start.");
+    return false;
+  }
+  captureFile = LittleFS.open(path, "w");
+  if (!captureFile) {
+    Serial.print("pfodCapture: Failed to open:"); Serial.println(path);
+    return false;
+  }
+  captureMaxBytes = maxBytes;
+  startCapture(&captureFile, withReplies);
+  Serial.print("pfodCapture started to "); Serial.println(path);
+  return true;
+}
+
+bool ESP32_start_pfodCapture(Print* out, bool withReplies) {
+  ESP32_stop_pfodCapture();
+  if (!out) {
+    return false;
+  }
+  captureMaxBytes = 0;
+  startCapture(out, withReplies);
+  return true;
+}
+
+void ESP32_stop_pfodCapture() {
+  if (!captureActive) {
+    return;
+  }
+  captureActive = false;
+  if (captureFile) {
+    captureFile.close();
+  }
+  captureOut = NULL;
+  Serial.print("pfodCapture stopped after "); Serial.print(captureBytes); Serial.println(" bytes");
+}
+
+bool pfodCapture_isActive() {
+  return captureActive;
+}
+
+void pfodCapture_flush() {
+  if (captureActive && captureFile) {
+    captureFile.flush();
+  }
+}
+
+void pfodCapture_record(uint8_t source, uint8_t slot, uint32_t start_ms, uint32_t duration_us,
+                        const char* cmd, size_t cmdLen, const char* reply, size_t replyLen) {
+  if (!captureActive) {
+    return;
+  }
+  if (cmdLen > 0xFFFF) {
+    cmdLen = 0xFFFF;
+  }
+  bool withReply = (captureReplies && reply);
+  size_t recordLen = 16 + cmdLen + (withReply ? replyLen : 0);
+  if (captureMaxBytes && ((captureBytes + recordLen) > captureMaxBytes)) {
+    if (debugPtr) {
+      debugPtr->println("pfodCapture: max size reached");
+    }
+    ESP32_stop_pfodCapture();
+    return;
+  }
+  captureOut->write((uint8_t)(withReply ? (source | PFOD_CAPTURE_HAS_REPLY) : source));
+  captureOut->write(slot);
+  writeU32(start_ms - captureStart_ms);
+  writeU32(duration_us);
+  writeU16((uint16_t)cmdLen);
+  writeU32(replyLen);
+  captureOut->write((const uint8_t*)cmd, cmdLen);
+  if (withReply) {
+    captureOut->write((const uint8_t*)reply, replyLen);
+  }
+  captureBytes += recordLen;
+}
+
+ESP32_pfodCaptureStream::ESP32_pfodCaptureStream() {
+  io = NULL;
+  slot = 0;
+  resetConnection();
+}
+
+void ESP32_pfodCaptureStream::setSlot(uint8_t _slot) {
+  slot = _slot;
+}
+
+void ESP32_pfodCaptureStream::resetConnection() {
+  msgDepth = 0;
+  awaitingReply = false;
+  requestStart_us = 0;
+  requestStart_ms = 0;
+  replyLen = 0;
+  cmdLen = 0;
+}
+
+Stream* ESP32_pfodCaptureStream::connect(Stream *_io) {
+  io = _io;
+  resetConnection();
+  return this;
+}
+
+void ESP32_pfodCaptureStream::stop() {
+  io = NULL;
+  resetConnection();
+}
+
+int ESP32_pfodCaptureStream::available() {
+  if (!io) {
+    return 0;
+  }
+  return io->available();
+}
+
+int ESP32_pfodCaptureStream::read() {
+  if (!io) {
+    return -1;
+  }
+  int c = io->read();
+  if ((c < 0) || (!captureActive)) {
+    return c;
+  }
+  if (!awaitingReply) {
+    awaitingReply = true;
+    requestStart_us = micros();
+    requestStart_ms = millis();
+    msgDepth = 0;
+    cmdLen = 0;
+    replyLen = 0;
+  }
+  if (cmdLen < CAPTURE_CMD_SIZE) {
+    cmdBuf[cmdLen++] = (char)c;
+  }
+  return c;
+}
+
+int ESP32_pfodCaptureStream::peek() {
+  if (!io) {
+    return -1;
+  }
+  return io->peek();
+}
+
+void ESP32_pfodCaptureStream::flush() {
+  if (io) {
+    io->flush();
+  }
+}
+
+int ESP32_pfodCaptureStream::availableForWrite() {
+  if (!io) {
+    return 0;
+  }
+  return io->availableForWrite();
+}
+
+size_t ESP32_pfodCaptureStream::write(const uint8_t *buf, size_t size) {
+  size_t n = 0;
+  for (; n < size; n++) {
+    if (!write(buf[n])) {
+      break;
+    }
+  }
+  return n;
+}
+
+size_t ESP32_pfodCaptureStream::write(uint8_t c) {
+  if (!io) {
+    return 0;
+  }
+  size_t n = io->write(c);
+  if ((!n) || (!awaitingReply)) {
+    return n;
+  }
+  replyLen++;
+  if (c == '{') {
+    msgDepth++;
+  } else if ((c == '}') && (msgDepth > 0)) {
+    msgDepth--;
+    if (msgDepth == 0) {
+      awaitingReply = false;
+      pfodCapture_record(PFOD_CAPTURE_APP, slot, requestStart_ms, micros() - requestStart_us, cmdBuf, cmdLen, NULL, replyLen);
+    }
+  }
+  return n;
+}
@@ -0,0 +1,76 @@
+#ifndef ESP32_PFOD_CAPTURE_H
+#define ESP32_PFOD_CAPTURE_H
+#include <Arduino.h>
+/*
+   ESP32_pfodCapture.h
+ * (c)2025 Forward Computing and Control Pty. Ltd.
+ * NSW Australia, www.forward.com.au
+ * This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+ * This generated code may be freely used for both private and commercial use
+ * provided this copyright is maintained.
+ */
+
+// Opt-in capture of the pfod cmds and replies handled by the servers, for replay with extras/pfodReplay.js
+// pfodWeb cmds are captured by ESP32_pfodWebServer
+// pfodApp cmds are captured by ESP32_pfodAppServer, by ESP32_pfodMsgClient when TxBufSize > 0
+// else, only if ESP32_PFOD_CAPTURE_BUFFERED_CLIENTS is defined in ESP32_pfodAppServer.h, by an ESP32_pfodCaptureStream
+// between each parser and its pfodESPBufferedClient for connections accepted while capture is active.
+// pfodESPBufferedClient sends as the reply is written, so those records only have the reply length, no reply bytes
+//
+// Binary format, all numbers little endian
+//  header  8 bytes "pfodCAP" + format version 1, uint32 flags (bit 0 set if capturing reply bytes)
+//  record  uint8 source (1 pfodWeb, 2 pfodApp, bit 7 set if reply bytes follow), uint8 slot,
+//          uint32 ms since capture started, uint32 us from cmd to reply,
+//          uint16 cmd length, uint32 reply length, cmd bytes, reply bytes (if source bit 7 set)
+
+const uint8_t PFOD_CAPTURE_WEB = 1;
+const uint8_t PFOD_CAPTURE_APP = 2;
+const uint8_t PFOD_CAPTURE_HAS_REPLY = 0x80;
+
+// capture to a LittleFS file, stops when file reaches maxBytes. The pfodWeb server will serve the file, e.g. http://<ip>/pfodCapture.bin
+// with Cache-Control no-store, flushing it first if capture is still running
+bool ESP32_start_pfodCapture(const char* path = "/pfodCapture.bin", bool withReplies = false, size_t maxBytes = 512 * 1024);
+// capture streamed to out, e.g. a WiFiClient
+bool ESP32_start_pfodCapture(Print* out, bool withReplies = false);
+void ESP32_stop_pfodCapture();
+bool pfodCapture_isActive();
+// writes the records so far to the LittleFS file, called by the pfodWeb server before serving a .bin file
+void pfodCapture_flush();
+
+// called by the servers, reply can be NULL if only the length is known
+void pfodCapture_record(uint8_t source, uint8_t slot, uint32_t start_ms, uint32_t duration_us,
+                        const char* cmd, size_t cmdLen, const char* reply, size_t replyLen);
+
+// Passes everything through to io and, while capture is active, records each cmd read
+// with the length of its reply and the time from the first cmd byte to the reply's closing }
+class ESP32_pfodCaptureStream : public Stream {
+  public:
+    ESP32_pfodCaptureStream();
+    void setSlot(uint8_t _slot);
+    Stream* connect(Stream *_io); // returns this
+    void stop();
+
+    // Stream methods
+    int available();
+    int read();
+    int peek();
+    void flush();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buf, size_t size);
+    int availableForWrite();
+
+  private:
+    void resetConnection();
+    static const size_t CAPTURE_CMD_SIZE = 128; // longer cmds are truncated in the capture
+
+    Stream *io;
+    uint16_t msgDepth; // { nesting, reply complete at the closing }
+    bool awaitingReply; // cmd bytes read, reply not finished yet
+    uint32_t requestStart_us;
+    uint32_t requestStart_ms;
+    size_t replyLen; // bytes written since the cmd was read
+    uint8_t slot;
+    uint8_t cmdLen;
+    char cmdBuf[CAPTURE_CMD_SIZE];
+};
+#endif
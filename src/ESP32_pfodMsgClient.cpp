@@ -0,0 +1,246 @@
+/*
+   ESP32_pfodMsgClient.cpp
+   (c)2025 Forward Computing and Control Pty. Ltd.
+   NSW Australia, www.forward.com.au
+   This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+   This generated code may be freely used for both private and commercial use
+   provided this copyright is maintained.
+*/
+
+#include "ESP32_pfodMsgClient.h"
+#include "ESP32_pfodCapture.h"
+#include <lwip/sockets.h>
+#include <errno.h>
+
+// debug control
+// see https://www.forward.com.au/pfod/ArduinoProgramming/Serial_IO/index.html  for how to used BufferedOutput
+// to prevent your sketch being held up by Serial
+// or just used debugPtr = &Serial
+static Print* debugPtr = NULL;  // local to this file
+
+ESP32_pfodMsgClient::ESP32_pfodMsgClient() {
+  client = NULL;
+  txBuf = NULL;
+  txBufSize = 0;
+  slot = 0;
+  clearStats();
+  resetConnection();
+}
+
+void ESP32_pfodMsgClient::setBuffer(uint8_t *_txBuf, size_t _txBufSize) {
+  txBuf = _txBuf;
+  txBufSize = _txBufSize;
+  txLen = 0;
+  txSent = 0;
+}
+
+void ESP32_pfodMsgClient::setSlot(uint8_t _slot) {
+  slot = _slot;
+}
+
+void ESP32_pfodMsgClient::resetConnection() {
+  txLen = 0;
+  txSent = 0;
+  msgDepth = 0;
+  msgComplete = false;
+  sendDelayed = false;
+  awaitingReply = false;
+  requestStart_us = 0;
+  requestStart_ms = 0;
+  sendStart_us = 0;
+  replyLen = 0;
+  cmdLen = 0;
+}
+
+Stream* ESP32_pfodMsgClient::connect(WiFiClient *_client) {
+  client = _client;
+  resetConnection();
+  clearStats();
+  if (client) {
+    client->setNoDelay(true); // each reply is sent in one write so no need to wait for more data
+  }
+  return this;
+}
+
+void ESP32_pfodMsgClient::stop() {
+  client = NULL; // the server stops the WiFiClient
+  resetConnection();
+}
+
+const ESP32_pfodMsgClientStats& ESP32_pfodMsgClient::getStats() const {
+  return stats;
+}
+
+void ESP32_pfodMsgClient::clearStats() {
+  memset(&stats, 0, sizeof(stats));
+  stats.minLatency_us = UINT32_MAX;
+}
+
+bool ESP32_pfodMsgClient::isBusy() {
+  if (txSent < txLen) {
+    sendPending();
+  }
+  return (txSent < txLen);
+}
+
+int ESP32_pfodMsgClient::available() {
+  if (!client) {
+    return 0;
+  }
+  return client->available();
+}
+
+int ESP32_pfodMsgClient::read() {
+  if (!client) {
+    return -1;
+  }
+  int c = client->read();
+  if ((c >= 0) && (!awaitingReply)) {
+    awaitingReply = true;
+    requestStart_us = micros();
+    requestStart_ms = millis();
+    cmdLen = 0;
+    replyLen = 0;
+  }
+  if ((c >= 0) && (cmdLen < CAPTURE_CMD_SIZE) && pfodCapture_isActive()) {
+    cmdBuf[cmdLen++] = (char)c;
+  }
+  return c;
+}
+
+int ESP32_pfodMsgClient::peek() {
+  if (!client) {
+    return -1;
+  }
+  return client->peek();
+}
+
+// sends what has been printed so far, does not wait
+void ESP32_pfodMsgClient::flush() {
+  if (sendStart_us == 0) {
+    sendStart_us = micros();
+  }
+  sendPending();
+}
+
+int ESP32_pfodMsgClient::availableForWrite() {
+  if (msgComplete) { // still sending last reply
+    return 0;
+  }
+  return txBufSize - txLen + txSent;
+}
+
+// every byte goes through write(c) so the {} are tracked even if some are dropped
+size_t ESP32_pfodMsgClient::write(const uint8_t *buf, size_t size) {
+  size_t n = 0;
+  for (size_t i = 0; i < size; i++) {
+    n += write(buf[i]);
+  }
+  return n;
+}
+
+size_t ESP32_pfodMsgClient::write(uint8_t c) {
+  if ((!client) || (!txBuf)) {
+    return 0;
+  }
+  if (msgComplete) {
+    // last msg still being sent, pfod only sends one reply per cmd, so don't wait for it or append to it
+    stats.droppedBytes++;
+    return 0;
+  }
+  if (txLen >= txBufSize) {
+    makeRoom();
+  }
+  bool stored = (txLen < txBufSize);
+  if (stored) {
+    txBuf[txLen++] = c;
+  } else {
+    // msg bigger than txBuf, only if bigger than MAX_PFOD_MSG_SIZE, keep tracking the {} so the reply still completes
+    stats.droppedBytes++;
+  }
+  replyLen++;
+  if (c == '{') {
+    msgDepth++;
+  } else if ((c == '}') && (msgDepth > 0)) {
+    msgDepth--;
+    if (msgDepth == 0) {
+      msgComplete = true;
+      sendStart_us = micros();
+      sendPending();
+    }
+  }
+  return stored ? 1 : 0;
+}
+
+void ESP32_pfodMsgClient::makeRoom() {
+  flush(); // send what can go now, does not wait
+  if ((txSent > 0) && (txSent < txLen)) {
+    memmove(txBuf, txBuf + txSent, txLen - txSent);
+    txLen -= txSent;
+    txSent = 0;
+  }
+}
+
+void ESP32_pfodMsgClient::sendPending() {
+  if (!client) {
+    return;
+  }
+  if (txSent < txLen) {
+    int sent = send(client->fd(), txBuf + txSent, txLen - txSent, MSG_DONTWAIT);
+    if (sent > 0) {
+      txSent += sent;
+    } else if ((sent < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+      if (debugPtr) {
+        debugPtr->print("pfodMsgClient send failed errno:"); debugPtr->println(errno);
+      }
+      client->stop(); // server will find this slot free
+      stop();
+      return;
+    }
+    if (txSent < txLen) {
+      if (!sendDelayed) {
+        sendDelayed = true;
+        stats.partialSends++;
+      }
+      return; // try again from isBusy()
+    }
+  }
+  // all sent
+  if (msgComplete) {
+    replyComplete();
+  }
+  txLen = 0;
+  txSent = 0;
+  sendDelayed = false;
+}
+
+void ESP32_pfodMsgClient::replyComplete() {
+  uint32_t now = micros();
+  msgComplete = false;
+  uint32_t sendTime = now - sendStart_us;
+  sendStart_us = 0;
+  if (sendTime > stats.maxSendTime_us) {
+    stats.maxSendTime_us = sendTime;
+  }
+  if (!awaitingReply) {
+    return; // unsolicited msg
+  }
+  awaitingReply = false;
+  uint32_t latency = now - requestStart_us;
+  stats.replies++;
+  stats.lastLatency_us = latency;
+  stats.totalLatency_us += latency;
+  if (latency < stats.minLatency_us) {
+    stats.minLatency_us = latency;
+  }
+  if (latency > stats.maxLatency_us) {
+    stats.maxLatency_us = latency;
+  }
+  if (pfodCapture_isActive()) {
+    // reply bytes only available if the whole reply is still in txBuf
+    const char *reply = (replyLen == txLen) ? (const char*)txBuf : NULL;
+    pfodCapture_record(PFOD_CAPTURE_APP, slot, requestStart_ms, latency, cmdBuf, cmdLen, reply, replyLen);
+  }
+  cmdLen = 0;
+  replyLen = 0;
+}
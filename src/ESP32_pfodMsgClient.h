@@ -0,0 +1,86 @@
+#ifndef ESP32_PFOD_MSG_CLIENT_H
+#define ESP32_PFOD_MSG_CLIENT_H
+#include <Arduino.h>
+/*
+   ESP32_pfodMsgClient.h
+ * (c)2025 Forward Computing and Control Pty. Ltd.
+ * NSW Australia, www.forward.com.au
+ * This code is not warranted to be fit for any purpose. You may only use it at your own risk.
+ * This generated code may be freely used for both private and commercial use
+ * provided this copyright is maintained.
+ */
+
+#include <WiFiClient.h>
+
+// Low latency alternative to pfodESPBufferedClient, used by ESP32_pfodAppServer when TxBufSize > 0
+// Turns on TCP_NODELAY and collects each pfod message {...} in the tx buffer
+// and sends it in one write when the closing } is printed.
+// Sends do not block, if the connection cannot take all of the msg the rest is sent from isBusy()
+// and the server does not parse any more input from this connection until the reply has gone.
+//
+// Sizing: pfod msgs are at most MAX_PFOD_MSG_SIZE bytes, larger drawings are sent as several msgs,
+// so a tx buffer of at least that size always holds a whole reply and write() never waits.
+// Bytes printed while the last msg is still being sent, or past the end of the tx buffer,
+// are not written and are counted in stats.droppedBytes.
+// When ESP32_pfodCapture is active each cmd and its reply are recorded.
+
+struct ESP32_pfodMsgClientStats {
+  uint32_t replies;       // number of pfod msgs sent
+  uint32_t lastLatency_us; // from first byte of cmd read to reply handed to TCP
+  uint32_t minLatency_us;
+  uint32_t maxLatency_us;
+  uint64_t totalLatency_us; // divide by replies for average
+  uint32_t maxSendTime_us; // longest time from closing } until the whole reply was handed to TCP
+  uint32_t partialSends;  // number of replies that could not be sent in one go
+  uint32_t droppedBytes;  // bytes not written, a second msg printed for one cmd or a msg bigger than the tx buffer
+};
+
+class ESP32_pfodMsgClient : public Stream {
+  public:
+    static const size_t MAX_PFOD_MSG_SIZE = 1024; // pfod msg size limit
+    ESP32_pfodMsgClient();
+    void setBuffer(uint8_t *_txBuf, size_t _txBufSize);
+    void setSlot(uint8_t _slot); // recorded by ESP32_pfodCapture
+    Stream* connect(WiFiClient *_client);
+    void stop();
+    // true if part of the last reply is still waiting to be sent, tries to send it
+    bool isBusy();
+    const ESP32_pfodMsgClientStats& getStats() const;
+    void clearStats();
+
+    // Stream methods
+    int available();
+    int read();
+    int peek();
+    void flush();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buf, size_t size);
+    int availableForWrite();
+
+  private:
+    void sendPending(); // non-blocking
+    void makeRoom(); // moves unsent bytes to the start of txBuf
+    void replyComplete();
+    void resetConnection();
+    static const size_t CAPTURE_CMD_SIZE = 128; // longer cmds are truncated in the capture
+
+    WiFiClient *client;
+    uint8_t *txBuf;
+    size_t txBufSize;
+    size_t txLen; // bytes in txBuf
+    size_t txSent; // bytes of txBuf already sent
+    uint16_t msgDepth; // { nesting, reply complete at the closing }
+    bool msgComplete; // closing } seen, stats updated when the last byte is sent
+    bool sendDelayed; // this reply could not all be sent in one go
+    bool awaitingReply; // cmd bytes read, reply not sent yet
+    uint32_t requestStart_us;
+    uint32_t requestStart_ms;
+    uint32_t sendStart_us;
+    size_t replyLen; // bytes written since the cmd was read
+    uint8_t slot;
+    uint8_t cmdLen;
+    char cmdBuf[CAPTURE_CMD_SIZE];
+    ESP32_pfodMsgClientStats stats;
+};
+
+#endif
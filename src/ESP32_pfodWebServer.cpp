@@ -8,7 +8,6 @@
 
 */
 #include "ESP32_pfodWebServer.h"
-#include <pfodParser.h>
 // This library needs handle_pfodMainMenu to be defined in the sketch
 extern void handle_pfodMainMenu(pfodParser & parser);
 
@@ -20,43 +19,87 @@ static Print* debugPtr = NULL;  // local to this file
 
 #include <WiFi.h>
 #include <NetworkClient.h>
-#include <WebServer.h>
 #include "ESP32_LittleFSsupport.h"
-#include "pfodStreamString.h" // string class to capture parser json output 
+#include "ESP32_pfodCapture.h"
 
 
 // comment out this line to force reload every time for testing
 // otherwise only reloads every 24hrs
 #define cacheControlStr "max-age=86400"
 
-static WebServer server(80);
-pfodParser webParser;
-pfodParser *webParserPtr = &webParser;
+// the uri's handled, others are loaded from LittleFS by handleNotFound()
+// only add cors to pfodWeb paths and fileNoFound
+const ESP32_pfodWebServerBase::Route ESP32_pfodWebServerBase::routes[] = {
+  {"/", HTTP_GET, &ESP32_pfodWebServerBase::handleIndex},
+  {"/index.html", HTTP_ANY, &ESP32_pfodWebServerBase::handleIndex}, // both GET and POST, to handle redirect after set time
+  {"/pfodWeb", HTTP_OPTIONS, &ESP32_pfodWebServerBase::handleCORS},
+  {"/pfodWeb", HTTP_GET, &ESP32_pfodWebServerBase::handle_pfodWeb},
+  {"/pfodWebDebug", HTTP_OPTIONS, &ESP32_pfodWebServerBase::handleCORS},
+  {"/pfodWebDebug", HTTP_GET, &ESP32_pfodWebServerBase::handle_pfodWebDebug},
+};
+const size_t ESP32_pfodWebServerBase::NO_OF_ROUTES = sizeof(routes) / sizeof(routes[0]);
+
+// content types for static files, anything else is sent as text/plain
+struct MimeType {
+  const char *extension;
+  const char *contentType;
+  bool noStore; // file changes while the server runs, don't let the browser cache it
+};
+static constexpr MimeType mimeTypes[] = {
+  {".html", "text/html", false},
+  {".css", "text/css", false},
+  {".js", "application/javascript", false},
+  {".ico", "image/x-icon", false},
+  {".bin", "application/octet-stream", true}, // pfodCapture files
+};
+
+// returns NULL if not in mimeTypes
+static const MimeType* getMimeType(const char *path) {
+  const char *extension = strrchr(path, '.');
+  if (extension) {
+    for (const MimeType & mimeType : mimeTypes) {
+      if (strcmp(extension, mimeType.extension) == 0) {
+        return &mimeType;
+      }
+    }
+  }
+  return NULL;
+}
 
+// default server only constructed if ESP32_start_pfodWebServer() etc are used
+static ESP32_pfodWebServer<>& defaultServer() {
+  static ESP32_pfodWebServer<> server;
+  return server;
+}
 
-static void handleIndex();
-static void handle_pfodWeb();
-static void handle_pfodWebDebug();
-static void printRequestArgs(Print *outPtr);
-static void handleNotFound();
-static bool loadFromFile(String path);
-static void redirect(const char *url);
-static void returnOK();
-static void returnFail(String msg);
-static bool sendHeaderAndTail(String & header, const char*tailPath);
+void pfodWeb_setVersion(const char* version) {
+  defaultServer().setVersion(version);
+}
 
-static bool serverStarted = false;
+void ESP32_start_pfodWebServer(const char* version, const char* _pfodWebServerURL) {
+  defaultServer().start(version, _pfodWebServerURL);
+}
 
-static String pfodWebServerURL;
+void ESP32_handle_pfodWebServer() {
+  defaultServer().handle();
+}
 
-void pfodWeb_setVersion(const char* version) {
-  webParser.setVersion(version);
+ESP32_pfodWebServerBase::ESP32_pfodWebServerBase(WebServer & _server) : server(_server) {
+  handler = handle_pfodMainMenu;
+  serverStarted = false;
+}
+
+void ESP32_pfodWebServerBase::setHandler(void (*_handler)(pfodParser & parser)) {
+  if (_handler) {
+    handler = _handler;
+  }
 }
 
-// Create a StringPrint object to capture JSON output
-pfodStreamString jsonCapture;
+void ESP32_pfodWebServerBase::setVersion(const char* version) {
+  webParser.setVersion(version);
+}
 
-void handleCORS() {
+void ESP32_pfodWebServerBase::handleCORS() {
   // Handle preflight OPTIONS requests
   server.sendHeader("Access-Control-Allow-Origin", "*");
   server.sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
@@ -66,7 +109,7 @@ void handleCORS() {
 }
 
 //NOTE esp32 server automatically applies urlDecode to args before using names/values
-static void handle_pfodWeb_page(bool _debug) {
+void ESP32_pfodWebServerBase::handle_pfodWeb_page(bool _debug) {
   if (debugPtr) {
     debugPtr->print("Handling request with "); debugPtr->println(_debug ? "debug true" : "debug false");
   }
@@ -90,6 +133,8 @@ static void handle_pfodWeb_page(bool _debug) {
   }
 
   if (isAjaxJsonRequest) {
+    uint32_t start_ms = millis();
+    uint32_t start_us = micros();
     jsonCapture.clear();
     jsonCapture.splitCmds = false; // don't interfer with | and }
     jsonCapture.print(cmdStr);
@@ -104,7 +149,7 @@ static void handle_pfodWeb_page(bool _debug) {
     jsonCapture.print('"');
 
     jsonCapture.splitCmds = true;
-    handle_pfodMainMenu(webParser); // capture parser output as json
+    handler(webParser); // capture parser output as json
     jsonCapture.splitCmds = false;
 
     // close the cmd array
@@ -118,6 +163,9 @@ static void handle_pfodWeb_page(bool _debug) {
       }
       // Send JSON response with proper content type
       server.send(200, "application/json", jsonCapture);
+      if (pfodCapture_isActive()) {
+        pfodCapture_record(PFOD_CAPTURE_WEB, 0, start_ms, micros() - start_us, cmdStr.c_str(), cmdStr.length(), jsonCapture.c_str(), jsonCapture.length());
+      }
       jsonCapture.clear();
     }
 
@@ -148,7 +196,7 @@ static void handle_pfodWeb_page(bool _debug) {
   }
 }
 
-static void handle_pfodWebDebug() {
+void ESP32_pfodWebServerBase::handle_pfodWebDebug() {
   if (debugPtr) {
     debugPtr->println("Handling /pfodWebDebug request");
     printRequestArgs(debugPtr);
@@ -157,7 +205,7 @@ static void handle_pfodWebDebug() {
 }
 
 //NOTE esp32 server automatically applies urlDecode to args before using names/values
-static void handle_pfodWeb() {
+void ESP32_pfodWebServerBase::handle_pfodWeb() {
   if (debugPtr) {
     debugPtr->println("Handling /pfodWeb request");
     printRequestArgs(debugPtr);
@@ -165,11 +213,11 @@ static void handle_pfodWeb() {
   handle_pfodWeb_page(false); // adds CORS
 }
 
-void ESP32_start_pfodWebServer(const char* version, const char* _pfodWebServerURL) {
+void ESP32_pfodWebServerBase::start(const char* version, const char* _pfodWebServerURL) {
   if (serverStarted) {
     return;
   }
-  pfodWeb_setVersion(version);
+  setVersion(version);
   if (_pfodWebServerURL) {
     pfodWebServerURL = _pfodWebServerURL;
     pfodWebServerURL.trim();
@@ -186,21 +234,18 @@ void ESP32_start_pfodWebServer(const char* version, const char* _pfodWebServerUR
     Serial.print(" Using pfodWebServer: "); Serial.print(pfodWebServerURL); Serial.println(" -- LittleFS not started here.");
   }
   
-  server.on("/", HTTP_GET, handleIndex);
-  server.on("/index.html", handleIndex); // both GET and POST, to handle redirect after set time
-  
-  // only add cors to pfodWeb paths and fileNoFound
-  server.on("/pfodWeb", HTTP_OPTIONS, handleCORS);
-  server.on("/pfodWeb", HTTP_GET, handle_pfodWeb);
-  server.on("/pfodWebDebug", HTTP_OPTIONS, handleCORS);
-  server.on("/pfodWebDebug", HTTP_GET, handle_pfodWebDebug);
-
-    // Handle 404s with CORS
-  server.onNotFound(handleNotFound);
-
-  (void)(returnOK); // to suppress compiler warning only
-  (void)(returnFail); // to suppress compiler warning only
-  (void)(redirect);  // to suppress compiler warning only
+  for (size_t i = 0; i < NO_OF_ROUTES; i++) {
+    // capture just two pointers so std::function stores the lambda inline,
+    // a member function pointer is too big and would cost a heap allocation per route
+    const Route *route = &routes[i];
+    server.on(route->uri, route->method, [this, route]() {
+      (this->*(route->handler))();
+    });
+  }
+  // Handle 404s with CORS
+  server.onNotFound([this]() {
+    handleNotFound();
+  });
 
   server.begin();
   Serial.println("pfodWeb server started");
@@ -209,15 +254,15 @@ void ESP32_start_pfodWebServer(const char* version, const char* _pfodWebServerUR
   webParser.connect(&jsonCapture); // connect parser to capture output
 }
 
-void ESP32_handle_pfodWebServer() {
+void ESP32_pfodWebServerBase::handle() {
   if (!serverStarted) {
-    Serial.println("Error: pfodWeb server not started.  Call ESP32_start_pfodWebServer() from setup()");
+    Serial.println("Error: pfodWeb server not started.  Call start() from setup()");
     return;
   }
   server.handleClient();
 }
 
-static void redirect(const char *url) {
+void ESP32_pfodWebServerBase::redirect(const char *url) {
   if (debugPtr) {
     debugPtr->print("Redirect to: ");    debugPtr->println(url);
   }
@@ -225,14 +270,14 @@ static void redirect(const char *url) {
   server.send(307);
 }
 
-static void returnOK() {
+void ESP32_pfodWebServerBase::returnOK() {
   if (debugPtr) {
     debugPtr->print("Return OK (empty plain text)");    debugPtr->println();
   }
   server.send(200, "text/plain", "");
 }
 
-static void returnFail(String msg) {
+void ESP32_pfodWebServerBase::returnFail(String msg) {
   msg += "\r\n";
   if (debugPtr) {
     debugPtr->print("Return Fail with msg: ");    debugPtr->println(msg);
@@ -240,7 +285,7 @@ static void returnFail(String msg) {
   server.send(500, "text/plain", msg);
 }
 
-static void printRequestArgs(Print * outPtr) {
+void ESP32_pfodWebServerBase::printRequestArgs(Print * outPtr) {
   if (!outPtr) {
     return;
   }
@@ -258,7 +303,7 @@ static void printRequestArgs(Print * outPtr) {
   }
 }
 
-static void handleNotFound() {
+void ESP32_pfodWebServerBase::handleNotFound() {
   if (loadFromFile(server.uri())) {
     return;
   }
@@ -282,7 +327,7 @@ static void handleNotFound() {
   server.send(404, "text/plain", message);
 }
 
-static bool sendHeaderAndTail(String & header, const char*tailPath) {
+bool ESP32_pfodWebServerBase::sendHeaderAndTail(String & header, const char*tailPath) {
   if (debugPtr) {
     debugPtr->print(" sendHeaderAndTail.  tail File: "); debugPtr->println(tailPath);
     debugPtr->print(" header:"); debugPtr->println(header);
@@ -314,7 +359,7 @@ static bool sendHeaderAndTail(String & header, const char*tailPath) {
 }
 
 
-static void handleIndex() {
+void ESP32_pfodWebServerBase::handleIndex() {
   if (pfodWebServerURL.length()) {
     String url = pfodWebServerURL;
     url += "/?ip=";
@@ -328,23 +373,18 @@ static void handleIndex() {
 
 
 // for .css, .js, and static .html .ico etc
-static bool loadFromFile(String path) {
+bool ESP32_pfodWebServerBase::loadFromFile(String path) {
   if (debugPtr) {
     debugPtr->print("Load File: ");    debugPtr->println(path);
   }
-  String dataType = "text/plain";
   if (path.endsWith("/")) {
     path += "localIndex.html";
   }
-
-  if (path.endsWith(".html")) {
-    dataType = "text/html";
-  } else if (path.endsWith(".css")) {
-    dataType = "text/css";
-  } else if (path.endsWith(".js")) {
-    dataType = "application/javascript";
-  } else if (path.endsWith(".ico")) {
-    dataType = "image/x-icon";
+  const MimeType *mimeType = getMimeType(path.c_str());
+  const char *dataType = mimeType ? mimeType->contentType : "text/plain";
+  bool noStore = mimeType && mimeType->noStore;
+  if (noStore) {
+    pfodCapture_flush(); // so a capture still running is complete up to its last record
   }
 
   File dataFile = LittleFS.open(path.c_str());
@@ -356,9 +396,13 @@ static bool loadFromFile(String path) {
     return false;
   }
 
+  if (noStore) {
+    server.sendHeader("Cache-Control", "no-store");
+  } else {
 #ifdef cacheControlStr
-  server.sendHeader("Cache-Control", cacheControlStr); // 24hrs
+    server.sendHeader("Cache-Control", cacheControlStr); // 24hrs
 #endif
+  }
   if (server.streamFile(dataFile, dataType) != dataFile.size()) {
     if (debugPtr) {
       debugPtr->print(" Sent less data than expected from file: ");    debugPtr->println(path);
@@ -2,7 +2,7 @@
 #define ESP32_PFOD_WEB_SERVER_H
 
 #include <Arduino.h>
-/*   
+/*
    ESP32_pfodWebServer.h
  * (c)2025 Forward Computing and Control Pty. Ltd.
  * NSW Australia, www.forward.com.au
@@ -11,7 +11,72 @@
  * provided this copyright is maintained.
  */
 
-void ESP32_start_pfodWebServer(const char* version, const char* _pfodWebServerURL = NULL); 
+#include <WebServer.h>
+#include <pfodParser.h>
+#include "pfodStreamString.h" // string class to capture parser json output
+
+// default server, uses port 80
+// This library needs handle_pfodMainMenu to be defined in the sketch
+void ESP32_start_pfodWebServer(const char* version, const char* _pfodWebServerURL = NULL);
 void ESP32_handle_pfodWebServer();  // call this each loop()
 void pfodWeb_setVersion(const char* version); // this is called from ESP32_start_pfodWebServer()
+
+// All the code is in ESP32_pfodWebServerBase, the template just supplies the WebServer for the port
+// e.g.
+//   ESP32_pfodWebServer<8080> secondServer;
+//   in setup()  secondServer.start(version);
+//   in loop()   secondServer.handle();
+class ESP32_pfodWebServerBase {
+  public:
+    void start(const char* version, const char* _pfodWebServerURL = NULL);
+    void handle(); // call this each loop()
+    void setVersion(const char* version);
+    // defaults to handle_pfodMainMenu
+    void setHandler(void (*_handler)(pfodParser & parser));
+
+  protected:
+    ESP32_pfodWebServerBase(WebServer & _server);
+
+  private:
+    ESP32_pfodWebServerBase(const ESP32_pfodWebServerBase&) = delete;
+    ESP32_pfodWebServerBase& operator=(const ESP32_pfodWebServerBase&) = delete;
+
+    struct Route {
+      const char *uri;
+      HTTPMethod method;
+      void (ESP32_pfodWebServerBase::*handler)();
+    };
+    static const Route routes[];
+    static const size_t NO_OF_ROUTES;
+
+    void handleCORS();
+    void handleIndex();
+    void handle_pfodWeb();
+    void handle_pfodWebDebug();
+    void handle_pfodWeb_page(bool _debug);
+    void handleNotFound();
+    void printRequestArgs(Print *outPtr);
+    bool loadFromFile(String path);
+    void redirect(const char *url);
+    void returnOK();
+    void returnFail(String msg);
+    bool sendHeaderAndTail(String & header, const char*tailPath);
+
+    WebServer &server;
+    pfodParser webParser;
+    pfodStreamString jsonCapture; // captures the parser output as JSON
+    String pfodWebServerURL;
+    void (*handler)(pfodParser & parser);
+    bool serverStarted;
+};
+
+template<uint16_t PortNo = 80>
+class ESP32_pfodWebServer : public ESP32_pfodWebServerBase {
+  public:
+    ESP32_pfodWebServer() : ESP32_pfodWebServerBase(webServer), webServer(PortNo) {
+    }
+  private:
+    WebServer webServer;
+};
+
 #endif